@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * Immutable set of address ranges, answering membership with a binary search
+ * over the sorted, merged ranges.
+ */
+class AddressRangeSet {
+    /**
+     * Sorted, non-overlapping [start, end) ranges.
+     */
+    std::vector<std::pair<uint64_t, uint64_t>> m_ranges;
+
+public:
+    AddressRangeSet() = default;
+
+    /**
+     * Build a set from [start, end) ranges, which may overlap. Empty ranges
+     * are ignored.
+     */
+    explicit AddressRangeSet(std::vector<std::pair<uint64_t, uint64_t>> ranges)
+    {
+        std::sort(ranges.begin(), ranges.end());
+        for (const auto& [start, end] : ranges) {
+            if (start >= end)
+                continue;
+            if (!m_ranges.empty() && start <= m_ranges.back().second)
+                m_ranges.back().second = std::max(m_ranges.back().second, end);
+            else
+                m_ranges.emplace_back(start, end);
+        }
+    }
+
+    /**
+     * Check if a value falls inside any of the ranges.
+     */
+    bool contains(uint64_t value) const
+    {
+        auto it = std::upper_bound(m_ranges.begin(), m_ranges.end(), value,
+            [](uint64_t v, const std::pair<uint64_t, uint64_t>& range) { return v < range.first; });
+        if (it == m_ranges.begin())
+            return false;
+
+        --it;
+        return value < it->second;
+    }
+
+    const std::vector<std::pair<uint64_t, uint64_t>>& ranges() const { return m_ranges; }
+    size_t size() const { return m_ranges.size(); }
+    bool empty() const { return m_ranges.empty(); }
+    size_t memoryUsage() const { return m_ranges.capacity() * sizeof(m_ranges[0]); }
+};
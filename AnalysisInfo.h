@@ -0,0 +1,167 @@
+#pragma once
+
+#include "AddressRangeSet.h"
+#include "CFStringIndex.h"
+#include "CandidateFilter.h"
+#include "ClassMethodIndex.h"
+#include "MethodTypeIndex.h"
+#include "ObjCStubs.h"
+#include "SelectorImplementationIndex.h"
+#include "SelectorStrings.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+/**
+ * Lookup tables built from a view's Objective-C metadata.
+ *
+ * Every address in the tables, both keys and values, is stored as an offset
+ * from the image base, so the tables stay valid when the view is rebased.
+ */
+struct AnalysisTables {
+    AddressRangeSet objcStubs;
+    SelectorImplementationIndex selRefToImp;
+    SelectorImplementationIndex selToImp;
+    CFStringIndex cfStrings;
+    CandidateFilter candidates;
+    SelectorStubIndex selectorStubs;
+    SelectorStrings selectorStrings;
+    ClassMethodIndex classes;
+    MethodTypeIndex methodTypes;
+
+    /**
+     * Get the approximate number of heap bytes used by the tables.
+     */
+    size_t memoryUsage() const
+    {
+        return sizeof(*this) + selRefToImp.memoryUsage() + selToImp.memoryUsage() + cfStrings.memoryUsage()
+            + candidates.memoryUsage() + selectorStubs.memoryUsage() + objcStubs.memoryUsage()
+            + selectorStrings.memoryUsage() + classes.memoryUsage() + methodTypes.memoryUsage();
+    }
+};
+
+/**
+ * Analysis info for a view at its current image base.
+ *
+ * Lookups take and return absolute addresses, applying the base to the
+ * image-relative tables, which are shared between every base the view has
+ * had. Rebasing only needs a new info with the same tables.
+ */
+struct AnalysisInfo {
+    std::uint64_t imageBase = 0;
+    std::shared_ptr<const AnalysisTables> tables;
+
+    uint64_t offset(uint64_t address) const { return address - imageBase; }
+
+    /**
+     * Check if an address is inside any of the view's `__objc_stubs` sections.
+     */
+    bool isObjcStub(uint64_t address) const { return tables->objcStubs.contains(offset(address)); }
+
+    /**
+     * Get the implementations for a selector, looked up first as a selector
+     * reference and then as a selector name address.
+     */
+    ImplementationSpan implementations(uint64_t selector) const
+    {
+        auto imps = tables->selRefToImp.find(offset(selector));
+        if (imps.empty())
+            imps = tables->selToImp.find(offset(selector));
+        return imps.rebased(imageBase);
+    }
+
+    /**
+     * Get the address of the backing string for the CFString at the given
+     * address, if there is one.
+     */
+    std::optional<uint64_t> cfString(uint64_t address) const
+    {
+        if (auto string = tables->cfStrings.find(offset(address)))
+            return *string + imageBase;
+        return std::nullopt;
+    }
+
+    /**
+     * Get the address of the selector passed by the `objc_msgSend$selector`
+     * stub at the given address, if it is a decoded stub.
+     */
+    std::optional<uint64_t> stubSelector(uint64_t address) const
+    {
+        if (auto selector = tables->selectorStubs.find(offset(address)))
+            return *selector + imageBase;
+        return std::nullopt;
+    }
+
+    /**
+     * Get the text of the selector at the given address, which may be either
+     * a selector name or a selector reference, from the view's snapshot of
+     * its selector names.
+     */
+    std::optional<std::string_view> selectorText(uint64_t address) const
+    {
+        const auto& strings = tables->selectorStrings;
+        if (auto text = strings.text(offset(address)))
+            return text;
+        if (auto name = strings.nameForRef(offset(address)))
+            return strings.text(*name);
+        return std::nullopt;
+    }
+
+    /**
+     * Check if an address is a class, rather than a metaclass, in the class
+     * method index.
+     */
+    bool isClass(uint64_t address) const { return tables->classes.isClass(offset(address)); }
+
+    /**
+     * Get the implementation a message send dispatches to for a receiver of
+     * a known class, if the class is in the image and implements the
+     * selector, possibly through its superclasses.
+     *
+     * @param isClassObject Whether the receiver is the class itself, which
+     * dispatches to its class methods, rather than an instance
+     * @param selector The selector name or selector reference passed
+     */
+    std::optional<uint64_t> methodImplementation(uint64_t cls, bool isClassObject, uint64_t selector) const
+    {
+        auto key = offset(cls);
+        if (isClassObject) {
+            const auto metaclass = tables->classes.metaclass(key);
+            if (!metaclass)
+                return std::nullopt;
+            key = *metaclass;
+        }
+
+        const auto name = tables->selectorStrings.nameForRef(offset(selector)).value_or(offset(selector));
+        if (auto implementation = tables->classes.find(key, name))
+            return *implementation + imageBase;
+        return std::nullopt;
+    }
+
+    /**
+     * Get the type encoding of the methods implementing a selector, if they
+     * all share one.
+     *
+     * @param selector The selector name or selector reference passed
+     */
+    std::optional<std::string_view> methodEncoding(uint64_t selector) const
+    {
+        const auto name = tables->selectorStrings.nameForRef(offset(selector)).value_or(offset(selector));
+        return tables->methodTypes.find(name);
+    }
+
+    /**
+     * Check if a constant falls inside the candidate filter.
+     */
+    bool isCandidate(uint64_t value) const { return tables->candidates.contains(offset(value)); }
+
+    /**
+     * Get the approximate number of heap bytes used by the info.
+     */
+    size_t memoryUsage() const { return sizeof(*this) + (tables ? tables->memoryUsage() : 0); }
+};
+
+typedef std::shared_ptr<AnalysisInfo> SharedAnalysisInfo;
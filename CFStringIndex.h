@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * Immutable map from the address of each `CFString` in the view to the
+ * address of its backing C string.
+ *
+ * Lookups are a range check against the span of all entries, followed by a
+ * binary search over the sorted entry addresses.
+ */
+class CFStringIndex {
+    std::vector<uint64_t> m_addresses;
+    std::vector<uint64_t> m_strings;
+
+public:
+    CFStringIndex() = default;
+
+    /**
+     * Build an index from (CFString address, C string address) pairs.
+     */
+    explicit CFStringIndex(std::vector<std::pair<uint64_t, uint64_t>> entries)
+    {
+        std::sort(entries.begin(), entries.end());
+        entries.erase(std::unique(entries.begin(), entries.end(),
+                          [](const auto& a, const auto& b) { return a.first == b.first; }),
+            entries.end());
+
+        m_addresses.reserve(entries.size());
+        m_strings.reserve(entries.size());
+        for (const auto& [address, string] : entries) {
+            m_addresses.push_back(address);
+            m_strings.push_back(string);
+        }
+    }
+
+    /**
+     * Get the address of the backing string for the CFString at the given
+     * address, if there is one.
+     */
+    std::optional<uint64_t> find(uint64_t address) const
+    {
+        if (m_addresses.empty() || address < m_addresses.front() || address > m_addresses.back())
+            return std::nullopt;
+
+        auto it = std::lower_bound(m_addresses.begin(), m_addresses.end(), address);
+        if (it == m_addresses.end() || *it != address)
+            return std::nullopt;
+
+        return m_strings[it - m_addresses.begin()];
+    }
+
+    /**
+     * Call `visitor(address, string)` for every entry in the index.
+     */
+    template <typename Visitor>
+    void forEach(Visitor&& visitor) const
+    {
+        for (size_t i = 0; i < m_addresses.size(); ++i)
+            visitor(m_addresses[i], m_strings[i]);
+    }
+
+    size_t size() const { return m_addresses.size(); }
+    bool empty() const { return m_addresses.empty(); }
+    size_t memoryUsage() const { return (m_addresses.capacity() + m_strings.capacity()) * sizeof(uint64_t); }
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "AnalysisInfo.h"
+#include "CallTargetTable.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * What the workflow found at a call site, before reading its selector.
+ */
+struct CallSite {
+    /**
+     * Kind of the call target. Calls to decoded selector stubs are reported
+     * as plain message sends.
+     */
+    CallTargetKind kind = CallTargetKind::None;
+
+    /**
+     * Selector passed to a message send, or zero if it isn't known.
+     */
+    uint64_t selector = 0;
+
+    /**
+     * Index of the integer argument holding the receiver.
+     */
+    size_t receiverArgument = 0;
+};
+
+/**
+ * Classify a call to `target`, and find the selector it passes if it is a
+ * message send.
+ *
+ * @param info The view's analysis info, if it has any
+ * @param argumentCount The number of integer argument registers
+ * @param argumentValue Callable returning the value of the integer argument
+ * at an index, or zero if it isn't known; only called for the selector
+ */
+template <typename ArgumentValue>
+CallSite classifyCallSite(const CallTargetTable& callTargets, const AnalysisInfo* info, uint64_t target,
+    size_t argumentCount, ArgumentValue&& argumentValue)
+{
+    CallSite site;
+    site.kind = callTargets.classify(target);
+
+    // A call to a decoded selector stub is a message send with the stub's
+    // selector. The stub may have no symbol if the binary is stripped, so
+    // decoded stubs are checked for regardless of kind.
+    if (info && (site.kind == CallTargetKind::SelectorStub || site.kind == CallTargetKind::None)) {
+        if (const auto stubSelector = info->stubSelector(target)) {
+            site.kind = CallTargetKind::MessageSend;
+            site.selector = *stubSelector;
+            return site;
+        }
+    }
+
+    if (!isMessageSend(site.kind))
+        return site;
+
+    // The selector is passed in the second integer argument, or the third for
+    // the struct-returning variants, which take the result pointer first. The
+    // receiver is passed in the argument before it.
+    const bool isStret
+        = site.kind == CallTargetKind::MessageSendStret || site.kind == CallTargetKind::MessageSendSuperStret;
+    const size_t selectorIndex = isStret ? 2 : 1;
+    site.receiverArgument = selectorIndex - 1;
+    if (argumentCount > selectorIndex)
+        site.selector = argumentValue(selectorIndex);
+
+    return site;
+}
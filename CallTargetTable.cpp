@@ -0,0 +1,27 @@
+#include "CallTargetTable.h"
+
+CallTargetTable::CallTargetTable(const std::vector<std::pair<uint64_t, CallTargetKind>>& targets)
+{
+    size_t capacity = 8;
+    while (capacity < targets.size() * 2)
+        capacity <<= 1;
+
+    m_slots.resize(capacity);
+    m_mask = capacity - 1;
+
+    for (const auto& [address, kind] : targets) {
+        if (address == 0 || kind == CallTargetKind::None)
+            continue;
+
+        for (size_t i = bucket(address);; ++i) {
+            auto& slot = m_slots[i & m_mask];
+            if (slot.address == address)
+                break;
+            if (slot.address == 0) {
+                slot = { address, kind };
+                ++m_size;
+                break;
+            }
+        }
+    }
+}
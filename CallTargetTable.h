@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * Kinds of call targets the workflow knows how to handle.
+ */
+enum class CallTargetKind : uint8_t {
+    None,
+
+    /**
+     * `objc_msgSend` and `objc_msgSend_fpret`/`_fp2ret`.
+     */
+    MessageSend,
+
+    /**
+     * `objc_msgSendSuper` and `objc_msgSendSuper2`.
+     */
+    MessageSendSuper,
+
+    /**
+     * `objc_msgSend_stret`, with the struct return pointer as the first
+     * argument.
+     */
+    MessageSendStret,
+
+    /**
+     * `objc_msgSendSuper_stret` and `objc_msgSendSuper2_stret`.
+     */
+    MessageSendSuperStret,
+
+    /**
+     * An `objc_msgSend$selector` stub, which loads its selector itself.
+     */
+    SelectorStub,
+
+    /**
+     * `objc_alloc`, which returns a new instance of the class passed as its
+     * first argument. `objc_alloc_init` and `objc_opt_new` are left out, as
+     * the initializer they run may return an object of another class.
+     */
+    Allocate,
+
+    /**
+     * `objc_opt_class`, which returns the class of the object passed as its
+     * first argument.
+     */
+    ClassOf,
+};
+
+/**
+ * Check if a call target kind is a member of the `objc_msgSend` family,
+ * which take the receiver and selector as their first arguments.
+ */
+constexpr bool isMessageSend(CallTargetKind kind)
+{
+    return kind == CallTargetKind::MessageSend || kind == CallTargetKind::MessageSendSuper
+        || kind == CallTargetKind::MessageSendStret || kind == CallTargetKind::MessageSendSuperStret;
+}
+
+/**
+ * Immutable, flat hash table from call target address to its kind.
+ *
+ * Uses open addressing with linear probing in a power-of-two table kept at
+ * most half full, so a lookup is almost always a single probe.
+ */
+class CallTargetTable {
+    struct Slot {
+        uint64_t address = 0;
+        CallTargetKind kind = CallTargetKind::None;
+    };
+
+    std::vector<Slot> m_slots;
+    size_t m_mask = 0;
+    size_t m_size = 0;
+
+    static size_t bucket(uint64_t address) { return (address * 0x9e3779b97f4a7c15ULL) >> 32; }
+
+public:
+    CallTargetTable() = default;
+
+    /**
+     * Build a table from (address, kind) pairs. Address zero is ignored, and
+     * the first kind given for an address wins.
+     */
+    explicit CallTargetTable(const std::vector<std::pair<uint64_t, CallTargetKind>>& targets);
+
+    /**
+     * Get the kind of the call target at the given address.
+     */
+    CallTargetKind classify(uint64_t address) const
+    {
+        if (m_slots.empty())
+            return CallTargetKind::None;
+
+        for (size_t i = bucket(address);; ++i) {
+            const auto& slot = m_slots[i & m_mask];
+            if (slot.address == address)
+                return slot.kind;
+            if (slot.address == 0)
+                return CallTargetKind::None;
+        }
+    }
+
+    /**
+     * Call `visitor(address, kind)` for every entry in the table.
+     */
+    template <typename Visitor>
+    void forEach(Visitor&& visitor) const
+    {
+        for (const auto& slot : m_slots)
+            if (slot.address)
+                visitor(slot.address, slot.kind);
+    }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    size_t memoryUsage() const { return m_slots.capacity() * sizeof(Slot); }
+};
@@ -0,0 +1,261 @@
+#include "CallTypeCache.h"
+
+#include <mutex>
+
+using namespace BinaryNinja;
+
+CallTypeCache::CallTypeCache()
+    : BinaryDataNotification(TypeDefined | TypeUndefined)
+{
+}
+
+std::shared_ptr<const CallTypeCache::ViewTypes> CallTypeCache::resolve(BinaryViewRef bv)
+{
+    const auto addressSize = bv->GetAddressSize();
+    auto types = std::make_shared<ViewTypes>();
+
+    types->idType = bv->GetTypeByName({ "id" });
+    if (!types->idType)
+        types->idType = Type::PointerType(addressSize, Type::VoidType());
+
+    types->selType = bv->GetTypeByName({ "SEL" });
+    if (!types->selType)
+        types->selType = Type::PointerType(addressSize, Type::IntegerType(1, true));
+
+    types->voidPointerType = Type::PointerType(addressSize, Type::VoidType());
+    types->classType = bv->GetTypeByName({ "Class" });
+    if (!types->classType)
+        types->classType = types->idType;
+
+    if (auto superType = bv->GetTypeByName({ "objc_super" }))
+        types->superType = Type::PointerType(addressSize, superType);
+    else
+        types->superType = types->voidPointerType;
+
+    types->callingConvention = bv->GetDefaultPlatform()->GetDefaultCallingConvention();
+    return types;
+}
+
+TypeRef CallTypeCache::decodedType(BinaryViewRef bv, const ViewTypes& types, const EncodedType& encoded)
+{
+    const auto addressSize = bv->GetAddressSize();
+
+    switch (encoded.kind) {
+    case EncodedTypeKind::Void:
+        return Type::VoidType();
+    case EncodedTypeKind::Bool:
+        return Type::BoolType();
+    case EncodedTypeKind::Char:
+        return Type::IntegerType(1, true);
+    case EncodedTypeKind::UnsignedChar:
+        return Type::IntegerType(1, false);
+    case EncodedTypeKind::Short:
+        return Type::IntegerType(2, true);
+    case EncodedTypeKind::UnsignedShort:
+        return Type::IntegerType(2, false);
+    case EncodedTypeKind::Int:
+        return Type::IntegerType(4, true);
+    case EncodedTypeKind::UnsignedInt:
+        return Type::IntegerType(4, false);
+    case EncodedTypeKind::LongLong:
+        return Type::IntegerType(8, true);
+    case EncodedTypeKind::UnsignedLongLong:
+        return Type::IntegerType(8, false);
+    case EncodedTypeKind::Float:
+        return Type::FloatType(4);
+    case EncodedTypeKind::Double:
+        return Type::FloatType(8);
+    case EncodedTypeKind::Object:
+        return types.idType;
+    case EncodedTypeKind::Class:
+        return types.classType;
+    case EncodedTypeKind::Selector:
+        return types.selType;
+    case EncodedTypeKind::CString:
+        return Type::PointerType(addressSize, Type::IntegerType(1, true));
+
+    // Arrays can only be passed by reference, so they are typed like
+    // pointers to their elements.
+    case EncodedTypeKind::Pointer:
+    case EncodedTypeKind::Array: {
+        EncodedType pointee;
+        pointee.kind = encoded.pointee;
+        pointee.name = encoded.name;
+
+        // Pointers to anything without a type of its own, such as a function
+        // or another pointer's target, point to void.
+        auto pointeeType = pointee.kind == EncodedTypeKind::Pointer ? types.voidPointerType : decodedType(bv, types, pointee);
+        if (!pointeeType)
+            pointeeType = Type::VoidType();
+        return Type::PointerType(addressSize, pointeeType);
+    }
+
+    // Aggregates are passed by value, so their layout has to be known for
+    // the arguments after them to land in the right registers.
+    case EncodedTypeKind::Struct:
+    case EncodedTypeKind::Union: {
+        if (encoded.name.empty())
+            return nullptr;
+
+        return bv->GetTypeByName({ std::string(encoded.name) });
+    }
+
+    default:
+        return nullptr;
+    }
+}
+
+TypeRef CallTypeCache::callType(
+    BinaryViewRef bv, const SelectorInfo& selector, CallTargetKind kind, std::optional<std::string_view> encoding)
+{
+    const KeyView key { kind, selector.argumentCount, selector.argumentNames, encoding.value_or(std::string_view()) };
+
+    std::shared_ptr<const ViewTypes> types;
+    uint64_t generation;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_lock);
+        if (auto it = m_callTypes.find(key); it != m_callTypes.end())
+            return it->second;
+        types = m_viewTypes;
+        generation = m_generation.load(std::memory_order_acquire);
+    }
+
+    // The type is built without the lock and published afterwards, unless
+    // the cache was invalidated in the meantime.
+    if (!types)
+        types = resolve(bv);
+
+    const bool isStret = kind == CallTargetKind::MessageSendStret || kind == CallTargetKind::MessageSendSuperStret;
+    const bool isSuper = kind == CallTargetKind::MessageSendSuper || kind == CallTargetKind::MessageSendSuperStret;
+
+    // Types are only taken from an encoding whose arguments, after the
+    // receiver and selector, match the selector's and can all be typed;
+    // otherwise the default types are used.
+    MethodSignature signature;
+    const bool isEncodingUsable = encoding && decodeMethodSignature(*encoding, signature)
+        && signature.argumentCount == selector.argumentCount + 2;
+
+    // Aggregates named by the encoding are registered before they are looked
+    // up, so that redefining one while this type is built invalidates it.
+    if (isEncodingUsable) {
+        std::unique_lock<std::shared_mutex> lock(m_lock);
+        auto addName = [&](const EncodedType& type) {
+            const auto isAggregate = [](EncodedTypeKind kind) {
+                return kind == EncodedTypeKind::Struct || kind == EncodedTypeKind::Union;
+            };
+            if (!type.name.empty() && (isAggregate(type.kind) || isAggregate(type.pointee)))
+                m_aggregateNames.emplace(type.name);
+        };
+        addName(signature.returnType);
+        for (size_t i = 2; i < signature.argumentCount; i++)
+            addName(signature.arguments[i]);
+    }
+
+    auto argType = Type::IntegerType(bv->GetAddressSize(), true);
+    std::vector<TypeRef> argTypes(selector.argumentCount, argType);
+    TypeRef returnType = isStret ? Type::VoidType() : types->idType;
+    if (isEncodingUsable) {
+        std::vector<TypeRef> decoded;
+        decoded.reserve(selector.argumentCount);
+        for (size_t i = 2; i < signature.argumentCount; i++) {
+            auto type = decodedType(bv, *types, signature.arguments[i]);
+            if (!type || signature.arguments[i].kind == EncodedTypeKind::Void)
+                break;
+            decoded.push_back(std::move(type));
+        }
+
+        if (decoded.size() == selector.argumentCount) {
+            argTypes = std::move(decoded);
+            if (!isStret) {
+                if (auto type = decodedType(bv, *types, signature.returnType))
+                    returnType = std::move(type);
+            }
+        }
+    }
+
+    std::vector<FunctionParameter> params;
+    if (isStret)
+        params.push_back({ "result", types->voidPointerType, true, Variable() });
+    if (isSuper)
+        params.push_back({ "super", types->superType, true, Variable() });
+    else
+        params.push_back({ "self", types->idType, true, Variable() });
+    params.push_back({ "sel", types->selType, true, Variable() });
+
+    const auto& argumentNames = selector.argumentNames;
+    for (size_t i = 0; i < selector.argumentCount; i++) {
+        if (argumentNames.size() > i && !argumentNames[i].empty())
+            params.push_back({ argumentNames[i], argTypes[i], true, Variable() });
+        else
+            params.push_back({ "arg" + std::to_string(i), argTypes[i], true, Variable() });
+    }
+
+    auto type = Type::FunctionType(returnType, types->callingConvention, params);
+
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    if (m_generation.load(std::memory_order_relaxed) != generation)
+        return type;
+    if (!m_viewTypes)
+        m_viewTypes = std::move(types);
+
+    // Another thread may have built the same type meanwhile; keep the first,
+    // so every call site shares one type object.
+    auto [it, isNew] = m_callTypes.emplace(
+        Key { kind, selector.argumentCount, selector.argumentNames, std::string(encoding.value_or(std::string_view())) },
+        std::move(type));
+    return it->second;
+}
+
+void CallTypeCache::invalidate()
+{
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    m_viewTypes = nullptr;
+    m_callTypes.clear();
+    m_aggregateNames.clear();
+    m_generation.fetch_add(1, std::memory_order_release);
+}
+
+size_t CallTypeCache::memoryUsage() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+
+    size_t bytes = 0;
+    for (const auto& [key, type] : m_callTypes) {
+        // Tree node: three links and a color, plus the value.
+        bytes += 4 * sizeof(void*) + sizeof(key) + sizeof(type);
+        for (const auto& name : std::get<2>(key))
+            bytes += sizeof(name) + name.capacity();
+        bytes += std::get<3>(key).capacity();
+    }
+    for (const auto& name : m_aggregateNames)
+        bytes += 4 * sizeof(void*) + sizeof(name) + name.capacity();
+
+    return bytes;
+}
+
+void CallTypeCache::invalidateIfRelevant(const QualifiedName& name)
+{
+    if (name == QualifiedName("id") || name == QualifiedName("SEL") || name == QualifiedName("Class")
+        || name == QualifiedName("objc_super")) {
+        invalidate();
+        return;
+    }
+
+    bool isAggregate;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_lock);
+        isAggregate = m_aggregateNames.count(name.GetString()) != 0;
+    }
+    if (isAggregate)
+        invalidate();
+}
+
+void CallTypeCache::OnTypeDefined(BinaryView*, const QualifiedName& name, Type*)
+{
+    invalidateIfRelevant(name);
+}
+
+void CallTypeCache::OnTypeUndefined(BinaryView*, const QualifiedName& name, Type*)
+{
+    invalidateIfRelevant(name);
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "BinaryNinja.h"
+#include "CallTargetTable.h"
+#include "SelectorTable.h"
+#include "TypeEncoding.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <string_view>
+#include <tuple>
+
+/**
+ * Per-view cache of the call types applied to `objc_msgSend` call sites.
+ *
+ * The `id` and `SEL` types and the default calling convention are resolved
+ * once, and the finished function type is memoized for each argument list so
+ * call sites using the same selector share one type object.
+ *
+ * Where the methods implementing a selector share a type encoding, the
+ * argument and return types are decoded from it, once per distinct encoding
+ * and argument list; otherwise every argument is an integer of the address
+ * size and the return type is `id`.
+ *
+ * The cache is registered as a notification on the view and resets itself
+ * whenever `id`, `SEL`, `Class`, `objc_super` or a struct named by an
+ * encoding it decoded is redefined. Types are only ever looked up on the
+ * view without holding the cache's lock, which those notifications take.
+ */
+class CallTypeCache : public BinaryNinja::BinaryDataNotification {
+    /**
+     * Kind, argument count, argument names, and type encoding, which is empty
+     * for the default types.
+     */
+    using Key = std::tuple<CallTargetKind, size_t, std::vector<std::string>, std::string>;
+
+    /**
+     * Borrowed form of a key, so lookups don't copy the argument names.
+     */
+    using KeyView = std::tuple<CallTargetKind, size_t, const std::vector<std::string>&, std::string_view>;
+
+    struct KeyLess {
+        using is_transparent = void;
+
+        static KeyView view(const Key& key)
+        {
+            return { std::get<0>(key), std::get<1>(key), std::get<2>(key), std::get<3>(key) };
+        }
+        static KeyView view(const KeyView& key) { return key; }
+
+        template <typename A, typename B>
+        bool operator()(const A& a, const B& b) const { return view(a) < view(b); }
+    };
+
+    /**
+     * View-level types used by every call type.
+     */
+    struct ViewTypes {
+        TypeRef idType;
+        TypeRef selType;
+        TypeRef superType;
+        TypeRef voidPointerType;
+        TypeRef classType;
+        BinaryNinja::Ref<BinaryNinja::CallingConvention> callingConvention;
+    };
+
+    mutable std::shared_mutex m_lock;
+    std::atomic<uint64_t> m_generation = 0;
+    std::shared_ptr<const ViewTypes> m_viewTypes;
+    std::map<Key, TypeRef, KeyLess> m_callTypes;
+
+    /**
+     * Names of the structs and unions looked up for decoded types.
+     */
+    std::set<std::string> m_aggregateNames;
+
+    /**
+     * Look up the view-level types used by every call type.
+     *
+     * This and `decodedType` query the view, which may deliver type
+     * notifications that take the lock, so they must be called without it.
+     */
+    static std::shared_ptr<const ViewTypes> resolve(BinaryViewRef);
+
+    /**
+     * Get the type of a value decoded from a type encoding, or null if it
+     * can't be represented faithfully, such as a struct the view doesn't
+     * define.
+     */
+    static TypeRef decodedType(BinaryViewRef, const ViewTypes&, const EncodedType&);
+
+    void invalidateIfRelevant(const BinaryNinja::QualifiedName&);
+
+public:
+    CallTypeCache();
+
+    /**
+     * Get the call type for a message send of the given kind using the given
+     * selector.
+     *
+     * @param encoding The type encoding of the methods implementing the
+     * selector, if known
+     */
+    TypeRef callType(BinaryViewRef, const SelectorInfo&, CallTargetKind,
+        std::optional<std::string_view> encoding = std::nullopt);
+
+    /**
+     * Drop all resolved types and memoized call types.
+     */
+    void invalidate();
+
+    /**
+     * Get the number of times the cache has been invalidated, so holders of
+     * call types obtained earlier can tell whether they are still current.
+     */
+    uint64_t generation() const { return m_generation.load(std::memory_order_acquire); }
+
+    /**
+     * Get the approximate number of heap bytes used by the cache, excluding
+     * the types themselves, which are owned by the core.
+     */
+    size_t memoryUsage() const;
+
+    void OnTypeDefined(BinaryNinja::BinaryView*, const BinaryNinja::QualifiedName&, BinaryNinja::Type*) override;
+    void OnTypeUndefined(BinaryNinja::BinaryView*, const BinaryNinja::QualifiedName&, BinaryNinja::Type*) override;
+};
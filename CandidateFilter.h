@@ -0,0 +1,42 @@
+#pragma once
+
+#include "AddressRangeSet.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * Immutable set of address ranges that a function must reference for the
+ * workflow to have any work to do in it.
+ *
+ * Used to skip functions before their SSA form is requested: a function whose
+ * IL contains no constant inside any of these ranges can't call a message
+ * send function or load a CFString.
+ */
+class CandidateFilter : public AddressRangeSet {
+public:
+    /**
+     * Granularity of page-relative address materialization (ADRP).
+     */
+    static constexpr uint64_t PageSize = 0x1000;
+
+    CandidateFilter() = default;
+
+    /**
+     * Build a filter from [start, end) ranges, which may overlap.
+     */
+    explicit CandidateFilter(std::vector<std::pair<uint64_t, uint64_t>> ranges)
+        : AddressRangeSet(std::move(ranges))
+    {
+    }
+
+    /**
+     * Get the range covering `[start, end)` and the page containing `start`,
+     * so that an address materialized as a page plus an offset still matches.
+     */
+    static std::pair<uint64_t, uint64_t> pageRange(uint64_t start, uint64_t end)
+    {
+        return { start & ~(PageSize - 1), end };
+    }
+};
@@ -0,0 +1,288 @@
+#include "Capture.h"
+
+namespace Capture {
+
+namespace {
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void putBytes(std::vector<uint8_t>& out, const void* data, size_t size)
+{
+    putVarint(out, size);
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+void putPairs(std::vector<uint8_t>& out, const std::vector<std::pair<uint64_t, uint64_t>>& pairs)
+{
+    putVarint(out, pairs.size());
+    for (const auto& [first, second] : pairs) {
+        putVarint(out, first);
+        putVarint(out, second);
+    }
+}
+
+/**
+ * Bounds-checked decoder for a record payload. Once a read runs past the end,
+ * every later read returns zero and `ok` is false.
+ */
+class Decoder {
+    const uint8_t* m_cursor;
+    const uint8_t* m_end;
+    bool m_ok = true;
+
+public:
+    Decoder(const uint8_t* begin, const uint8_t* end)
+        : m_cursor(begin)
+        , m_end(end)
+    {
+    }
+
+    bool ok() const { return m_ok; }
+    bool atEnd() const { return m_cursor == m_end; }
+
+    uint8_t byte()
+    {
+        if (!m_ok || m_cursor == m_end) {
+            m_ok = false;
+            return 0;
+        }
+        return *m_cursor++;
+    }
+
+    uint64_t varint()
+    {
+        uint64_t value = 0;
+        for (unsigned shift = 0; m_ok; shift += 7) {
+            if (m_cursor == m_end || shift > 63) {
+                m_ok = false;
+                break;
+            }
+
+            const auto byte = *m_cursor++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        return 0;
+    }
+
+    /**
+     * Read a count of items that each take at least `minimumSize` bytes,
+     * rejecting counts the remaining payload can't hold.
+     */
+    size_t count(size_t minimumSize = 1)
+    {
+        const auto value = varint();
+        if (value > static_cast<size_t>(m_end - m_cursor) / minimumSize) {
+            m_ok = false;
+            return 0;
+        }
+        return static_cast<size_t>(value);
+    }
+
+    template <typename Container>
+    void bytes(Container& out)
+    {
+        const auto size = count();
+        out.assign(m_cursor, m_cursor + size);
+        m_cursor += size;
+    }
+
+    void pairs(std::vector<std::pair<uint64_t, uint64_t>>& out)
+    {
+        out.resize(count(2));
+        for (auto& [first, second] : out) {
+            first = varint();
+            second = varint();
+        }
+    }
+};
+
+} // unnamed namespace
+
+Writer::Writer(const std::string& path)
+    : m_file(std::fopen(path.c_str(), "wb"))
+{
+    if (!m_file)
+        return;
+
+    const uint32_t header[] = { Magic, Version };
+    std::fwrite(header, sizeof(header), 1, m_file);
+}
+
+Writer::~Writer()
+{
+    if (m_file)
+        std::fclose(m_file);
+}
+
+void Writer::writeRecord(RecordType type, const std::vector<uint8_t>& payload)
+{
+    if (!m_file)
+        return;
+
+    m_buffer.clear();
+    m_buffer.push_back(static_cast<uint8_t>(type));
+    putVarint(m_buffer, payload.size());
+    std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+    std::fwrite(payload.data(), 1, payload.size(), m_file);
+}
+
+void Writer::write(const ViewRecord& view)
+{
+    std::vector<uint8_t> payload;
+    putVarint(payload, view.session);
+    putVarint(payload, view.imageBase);
+
+    putVarint(payload, view.callTargets.size());
+    for (const auto& [address, kind] : view.callTargets) {
+        putVarint(payload, address);
+        putVarint(payload, static_cast<uint64_t>(kind));
+    }
+
+    putPairs(payload, view.cfStrings);
+    putPairs(payload, view.selectorStubs);
+    putBytes(payload, view.selectorIndexes.data(), view.selectorIndexes.size());
+    putBytes(payload, view.selectorStrings.data(), view.selectorStrings.size());
+    putBytes(payload, view.classes.data(), view.classes.size());
+    putBytes(payload, view.methodTypes.data(), view.methodTypes.size());
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    writeRecord(RecordType::View, payload);
+}
+
+void Writer::write(const FunctionRecord& function)
+{
+    std::vector<uint8_t> payload;
+    putVarint(payload, function.session);
+    putVarint(payload, function.start);
+    payload.push_back(function.flags);
+
+    // Instruction addresses are stored relative to the function start, which
+    // keeps them to a byte or two each.
+    putVarint(payload, function.instructions.size());
+    for (const auto& insn : function.instructions) {
+        payload.push_back(static_cast<uint8_t>(insn.operation));
+        putVarint(payload, insn.address - function.start);
+        putVarint(payload, insn.value);
+        if (insn.operation != Instruction::Operation::Call)
+            continue;
+
+        payload.push_back(insn.argumentCount);
+        for (size_t i = 0; i < insn.argumentCount; ++i)
+            putVarint(payload, insn.arguments[i]);
+        putBytes(payload, insn.selector.data(), insn.selector.size());
+    }
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    writeRecord(RecordType::Function, payload);
+}
+
+Reader::Reader(const std::string& path)
+    : m_file(std::fopen(path.c_str(), "rb"))
+{
+    if (!m_file)
+        return;
+
+    uint32_t header[2] = {};
+    if (std::fread(header, sizeof(header), 1, m_file) != 1 || header[0] != Magic || header[1] != Version) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+Reader::~Reader()
+{
+    if (m_file)
+        std::fclose(m_file);
+}
+
+bool Reader::next(RecordType& type, ViewRecord& view, FunctionRecord& function)
+{
+    if (!m_file)
+        return false;
+
+    const auto typeByte = std::fgetc(m_file);
+    if (typeByte == EOF)
+        return false;
+
+    uint64_t length = 0;
+    for (unsigned shift = 0;; shift += 7) {
+        const auto byte = std::fgetc(m_file);
+        if (byte == EOF || shift > 63)
+            return false;
+        length |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            break;
+    }
+
+    m_payload.resize(length);
+    if (length && std::fread(m_payload.data(), 1, length, m_file) != length)
+        return false;
+
+    Decoder decoder(m_payload.data(), m_payload.data() + m_payload.size());
+    type = static_cast<RecordType>(typeByte);
+    switch (type) {
+    case RecordType::View:
+        view.session = decoder.varint();
+        view.imageBase = decoder.varint();
+        view.callTargets.resize(decoder.count(2));
+        for (auto& [address, kind] : view.callTargets) {
+            address = decoder.varint();
+            kind = static_cast<CallTargetKind>(decoder.varint());
+        }
+        decoder.pairs(view.cfStrings);
+        decoder.pairs(view.selectorStubs);
+        decoder.bytes(view.selectorIndexes);
+        decoder.bytes(view.selectorStrings);
+        decoder.bytes(view.classes);
+        decoder.bytes(view.methodTypes);
+        break;
+
+    case RecordType::Function:
+        function.session = decoder.varint();
+        function.start = decoder.varint();
+        function.flags = static_cast<uint8_t>(decoder.byte());
+        if (function.flags & ~FunctionRecord::AllFlags)
+            return false;
+
+        function.instructions.resize(decoder.count(3));
+        for (auto& insn : function.instructions) {
+            const auto operation = decoder.byte();
+            if (operation > static_cast<uint8_t>(Instruction::Operation::Last))
+                return false;
+
+            insn.operation = static_cast<Instruction::Operation>(operation);
+            insn.address = function.start + decoder.varint();
+            insn.value = decoder.varint();
+            insn.argumentCount = 0;
+            insn.selector.clear();
+            if (insn.operation != Instruction::Operation::Call)
+                continue;
+
+            insn.argumentCount = decoder.byte();
+            if (insn.argumentCount > Instruction::MaxArguments)
+                return false;
+            for (size_t i = 0; i < insn.argumentCount; ++i)
+                insn.arguments[i] = decoder.varint();
+            decoder.bytes(insn.selector);
+        }
+        break;
+
+    default:
+        // Unknown records are skipped, so newer captures stay readable.
+        return true;
+    }
+
+    return decoder.ok() && decoder.atEnd();
+}
+
+}
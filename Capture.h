@@ -0,0 +1,168 @@
+#pragma once
+
+#include "CallTargetTable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Streaming capture of the inputs the workflow's rewrite decisions are made
+ * from, so they can be replayed without Binary Ninja.
+ *
+ * A capture file is a header followed by a stream of records, each a type
+ * byte, a varint payload length and the payload, with all integers in the
+ * payload encoded as varints. Every view contributes one view record with its
+ * lookup tables, followed by one function record per function analyzed,
+ * including functions skipped by the candidate filter or served from the
+ * function memo.
+ */
+namespace Capture {
+
+constexpr uint32_t Magic = 0x43524e4f; // "ONRC"
+constexpr uint32_t Version = 2;
+
+enum class RecordType : uint8_t {
+    View = 1,
+    Function = 2,
+};
+
+/**
+ * Lookup tables of a view, with every table address image-relative.
+ */
+struct ViewRecord {
+    uint64_t session = 0;
+    uint64_t imageBase = 0;
+
+    /**
+     * Absolute call target addresses, as classified by the view's message
+     * handler.
+     */
+    std::vector<std::pair<uint64_t, CallTargetKind>> callTargets;
+
+    std::vector<std::pair<uint64_t, uint64_t>> cfStrings;
+    std::vector<std::pair<uint64_t, uint64_t>> selectorStubs;
+
+    /**
+     * The selector reference and selector name indexes, serialized back to
+     * back by `SelectorImplementationIndex::serialize`.
+     */
+    std::vector<uint8_t> selectorIndexes;
+
+    /**
+     * The selector strings snapshot, class method index and method type
+     * index, each serialized by its own `serialize`.
+     */
+    std::vector<uint8_t> selectorStrings;
+    std::vector<uint8_t> classes;
+    std::vector<uint8_t> methodTypes;
+};
+
+/**
+ * A call or register assignment the workflow looked at.
+ */
+struct Instruction {
+    enum class Operation : uint8_t {
+        Call,
+        SetRegister,
+        Last = SetRegister,
+    };
+
+    static constexpr size_t MaxArguments = 3;
+
+    Operation operation = Operation::Call;
+    uint64_t address = 0;
+
+    /**
+     * The call target, or the value assigned to the register.
+     */
+    uint64_t value = 0;
+
+    /**
+     * Values of the first integer arguments of a call, zero where unknown.
+     */
+    uint8_t argumentCount = 0;
+    uint64_t arguments[MaxArguments] = {};
+
+    /**
+     * Text of the selector passed, if the call is a message send with a
+     * known selector; empty if it couldn't be read.
+     */
+    std::string selector;
+};
+
+struct FunctionRecord {
+    /**
+     * The candidate filter found nothing to rewrite, so no instructions were
+     * looked at.
+     */
+    static constexpr uint8_t Skipped = 1 << 0;
+
+    /**
+     * The rewrites were reapplied from the function memo.
+     */
+    static constexpr uint8_t Memoized = 1 << 1;
+
+    static constexpr uint8_t AllFlags = Skipped | Memoized;
+
+    uint64_t session = 0;
+    uint64_t start = 0;
+    uint8_t flags = 0;
+    std::vector<Instruction> instructions;
+};
+
+/**
+ * Appends records to a capture file. Records may be written from any thread.
+ */
+class Writer {
+    std::FILE* m_file = nullptr;
+    std::mutex m_lock;
+    std::vector<uint8_t> m_buffer;
+
+    void writeRecord(RecordType, const std::vector<uint8_t>& payload);
+
+public:
+    explicit Writer(const std::string& path);
+    ~Writer();
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    bool isOpen() const { return m_file != nullptr; }
+
+    void write(const ViewRecord&);
+    void write(const FunctionRecord&);
+};
+
+/**
+ * Reads the records of a capture file in order.
+ */
+class Reader {
+    std::FILE* m_file = nullptr;
+    std::vector<uint8_t> m_payload;
+
+public:
+    explicit Reader(const std::string& path);
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    /**
+     * Whether the file was opened and has a valid header.
+     */
+    bool isOpen() const { return m_file != nullptr; }
+
+    /**
+     * Read the next record, filling in whichever of the records matches its
+     * type. Returns false at the end of the file or on a malformed record,
+     * including one with an unknown instruction operation or function flag.
+     */
+    bool next(RecordType& type, ViewRecord& view, FunctionRecord& function);
+};
+
+}
@@ -0,0 +1,163 @@
+#include "ClassMethodIndex.h"
+
+#include "Serialization.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace Serialization;
+
+void ClassMethodIndex::Builder::addClass(uint64_t address, uint64_t superclass, uint64_t metaclass, Methods methods)
+{
+    m_classes.push_back({ address, superclass, metaclass, std::move(methods) });
+}
+
+void ClassMethodIndex::Builder::addCategory(uint64_t cls, Methods methods)
+{
+    m_categories.emplace_back(cls, std::move(methods));
+}
+
+ClassMethodIndex ClassMethodIndex::Builder::build()
+{
+    // Sort both lists by class, keeping insertion order for duplicates; the
+    // first definition of a class wins.
+    std::stable_sort(m_classes.begin(), m_classes.end(),
+        [](const Class& a, const Class& b) { return a.address < b.address; });
+    m_classes.erase(std::unique(m_classes.begin(), m_classes.end(),
+                        [](const Class& a, const Class& b) { return a.address == b.address; }),
+        m_classes.end());
+    std::stable_sort(m_categories.begin(), m_categories.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    auto findClass = [&](uint64_t address) -> const Class* {
+        auto it = std::lower_bound(m_classes.begin(), m_classes.end(), address,
+            [](const Class& c, uint64_t a) { return c.address < a; });
+        return it != m_classes.end() && it->address == address ? &*it : nullptr;
+    };
+
+    ClassMethodIndex index;
+    index.m_classes.reserve(m_classes.size());
+    index.m_metaclasses.reserve(m_classes.size());
+    index.m_offsets.reserve(m_classes.size() + 1);
+
+    Methods flattened;
+    for (const auto& cls : m_classes) {
+        // Walk up the hierarchy, most-derived first, with each level's
+        // categories ahead of its own methods. The walk is bounded by the
+        // number of classes in case the superclass chain has a cycle.
+        flattened.clear();
+        const Class* level = &cls;
+        for (size_t depth = 0; level && depth < m_classes.size(); ++depth) {
+            auto [begin, end] = std::equal_range(m_categories.begin(), m_categories.end(),
+                std::make_pair(level->address, Methods()),
+                [](const auto& a, const auto& b) { return a.first < b.first; });
+            for (auto it = begin; it != end; ++it)
+                flattened.insert(flattened.end(), it->second.begin(), it->second.end());
+            flattened.insert(flattened.end(), level->methods.begin(), level->methods.end());
+
+            level = level->superclass ? findClass(level->superclass) : nullptr;
+        }
+
+        // Keep the most-derived implementation of each selector.
+        std::stable_sort(flattened.begin(), flattened.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+        flattened.erase(std::unique(flattened.begin(), flattened.end(),
+                            [](const auto& a, const auto& b) { return a.first == b.first; }),
+            flattened.end());
+
+        index.m_classes.push_back(cls.address);
+        index.m_metaclasses.push_back(cls.metaclass);
+        index.m_offsets.push_back(static_cast<uint32_t>(index.m_selectors.size()));
+        for (const auto& [selector, implementation] : flattened) {
+            index.m_selectors.push_back(selector);
+            index.m_implementations.push_back(implementation);
+        }
+    }
+    index.m_offsets.push_back(static_cast<uint32_t>(index.m_selectors.size()));
+
+    m_classes.clear();
+    m_categories.clear();
+    return index;
+}
+
+std::optional<size_t> ClassMethodIndex::position(uint64_t cls) const
+{
+    if (m_classes.empty() || cls < m_classes.front() || cls > m_classes.back())
+        return std::nullopt;
+
+    auto it = std::lower_bound(m_classes.begin(), m_classes.end(), cls);
+    if (it == m_classes.end() || *it != cls)
+        return std::nullopt;
+
+    return it - m_classes.begin();
+}
+
+std::optional<uint64_t> ClassMethodIndex::metaclass(uint64_t cls) const
+{
+    const auto i = position(cls);
+    if (!i || !m_metaclasses[*i])
+        return std::nullopt;
+
+    return m_metaclasses[*i];
+}
+
+std::optional<uint64_t> ClassMethodIndex::find(uint64_t cls, uint64_t selector) const
+{
+    const auto i = position(cls);
+    if (!i)
+        return std::nullopt;
+
+    const auto begin = m_selectors.begin() + m_offsets[*i];
+    const auto end = m_selectors.begin() + m_offsets[*i + 1];
+    auto it = std::lower_bound(begin, end, selector);
+    if (it == end || *it != selector)
+        return std::nullopt;
+
+    return m_implementations[it - m_selectors.begin()];
+}
+
+void ClassMethodIndex::serialize(std::vector<uint8_t>& out) const
+{
+    writeValue(out, m_classes.size());
+    writeValue(out, m_selectors.size());
+    writeArray(out, m_classes.data(), m_classes.size());
+    writeArray(out, m_metaclasses.data(), m_metaclasses.size());
+    if (m_offsets.empty()) {
+        // A default-constructed index has no offsets at all; write the single
+        // offset an empty built index would have.
+        const uint32_t offset = 0;
+        writeArray(out, &offset, 1);
+    } else {
+        writeArray(out, m_offsets.data(), m_offsets.size());
+    }
+    writeArray(out, m_selectors.data(), m_selectors.size());
+    writeArray(out, m_implementations.data(), m_implementations.size());
+}
+
+std::optional<ClassMethodIndex> ClassMethodIndex::deserialize(const uint8_t*& data, const uint8_t* end)
+{
+    uint64_t classCount, methodCount;
+    if (!readValue(data, end, classCount) || !readValue(data, end, methodCount))
+        return std::nullopt;
+    if (classCount >= UINT32_MAX || methodCount > UINT32_MAX)
+        return std::nullopt;
+
+    ClassMethodIndex index;
+    if (!readArray(data, end, index.m_classes, classCount) || !readArray(data, end, index.m_metaclasses, classCount)
+        || !readArray(data, end, index.m_offsets, classCount + 1)
+        || !readArray(data, end, index.m_selectors, methodCount)
+        || !readArray(data, end, index.m_implementations, methodCount)) {
+        return std::nullopt;
+    }
+
+    // Classes are binary searched, and offsets must describe valid runs,
+    // since lookups index with them directly.
+    if (std::adjacent_find(index.m_classes.begin(), index.m_classes.end(), std::greater_equal<uint64_t>())
+            != index.m_classes.end()
+        || index.m_offsets.front() != 0 || index.m_offsets.back() != methodCount
+        || !std::is_sorted(index.m_offsets.begin(), index.m_offsets.end())) {
+        return std::nullopt;
+    }
+
+    return index;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * Immutable map from a class and a selector to the method a message send to
+ * an instance of that class dispatches to.
+ *
+ * Each class's methods are flattened together with those of its categories
+ * and of its superclasses within the image, most-derived first, and stored
+ * as one contiguous run of (selector, implementation) pairs sorted by
+ * selector. Resolving a call is a binary search for the class followed by
+ * one over its run. Metaclasses are classes of their own, so class methods
+ * resolve the same way through a class's metaclass.
+ */
+class ClassMethodIndex {
+    std::vector<uint64_t> m_classes;
+    std::vector<uint64_t> m_metaclasses;
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint64_t> m_selectors;
+    std::vector<uint64_t> m_implementations;
+
+    /**
+     * Get the position of a class in the index, if it is present.
+     */
+    std::optional<size_t> position(uint64_t cls) const;
+
+public:
+    using Methods = std::vector<std::pair<uint64_t, uint64_t>>;
+
+    /**
+     * Accumulates classes and categories for an index, then flattens them.
+     */
+    class Builder {
+        struct Class {
+            uint64_t address;
+            uint64_t superclass;
+            uint64_t metaclass;
+            Methods methods;
+        };
+
+        std::vector<Class> m_classes;
+        std::vector<std::pair<uint64_t, Methods>> m_categories;
+
+    public:
+        /**
+         * Add a class with its own (selector, implementation) pairs.
+         *
+         * @param superclass The superclass's address, or zero for a root
+         * class or one whose superclass is outside the image
+         * @param metaclass The class's metaclass, or zero if the class is
+         * itself a metaclass
+         */
+        void addClass(uint64_t address, uint64_t superclass, uint64_t metaclass, Methods methods);
+
+        /**
+         * Add methods from a category on a class. Category methods take
+         * precedence over the class's own.
+         */
+        void addCategory(uint64_t cls, Methods methods);
+
+        /**
+         * Flatten the accumulated classes into an index.
+         */
+        ClassMethodIndex build();
+    };
+
+    ClassMethodIndex() = default;
+
+    /**
+     * Check if the address is a class, not a metaclass, in the index.
+     */
+    bool isClass(uint64_t address) const { return metaclass(address).has_value(); }
+
+    /**
+     * Get the metaclass of a class in the index.
+     */
+    std::optional<uint64_t> metaclass(uint64_t cls) const;
+
+    /**
+     * Get the implementation a message with the given selector sent to an
+     * instance of `cls` dispatches to. Returns nothing if the class is not in
+     * the index, or neither it nor its superclasses in the image implement
+     * the selector.
+     */
+    std::optional<uint64_t> find(uint64_t cls, uint64_t selector) const;
+
+    /**
+     * Append the index to a buffer in a compact binary form that can be
+     * loaded back with `deserialize`. The encoding uses the host's byte order.
+     */
+    void serialize(std::vector<uint8_t>& out) const;
+
+    /**
+     * Load an index written by `serialize`, advancing `data` past it.
+     * Returns nothing if the data is truncated or inconsistent.
+     */
+    static std::optional<ClassMethodIndex> deserialize(const uint8_t*& data, const uint8_t* end);
+
+    /**
+     * Get the number of classes and metaclasses in the index.
+     */
+    size_t size() const { return m_classes.size(); }
+    bool empty() const { return m_classes.empty(); }
+
+    /**
+     * Get the total number of flattened methods.
+     */
+    size_t methodCount() const { return m_selectors.size(); }
+
+    size_t memoryUsage() const
+    {
+        return (m_classes.capacity() + m_metaclasses.capacity() + m_selectors.capacity()
+                   + m_implementations.capacity())
+            * sizeof(uint64_t)
+            + m_offsets.capacity() * sizeof(uint32_t);
+    }
+};
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <utility>
+
+/**
+ * Incremental, non-cryptographic 128-bit hash of a sequence of values and
+ * byte ranges, used to tell whether two views were built from the same
+ * content.
+ *
+ * Values and byte ranges are fed in as 64-bit words, which are hashed in
+ * pairs with the MurmurHash3 x64 128-bit block function and finalizer, so
+ * hashing a large section runs at memory speed and every input bit affects
+ * both halves of the digest.
+ */
+class ContentHash {
+    static constexpr uint64_t C1 = 0x87c37b91114253d5ULL;
+    static constexpr uint64_t C2 = 0x4cf5ad432745937fULL;
+
+    uint64_t m_h1 = 0x243f6a8885a308d3ULL;
+    uint64_t m_h2 = 0x13198a2e03707344ULL;
+    uint64_t m_pending = 0;
+    bool m_hasPending = false;
+    uint64_t m_length = 0;
+
+    static uint64_t rotl(uint64_t value, int shift) { return (value << shift) | (value >> (64 - shift)); }
+
+    static uint64_t fmix(uint64_t k)
+    {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    }
+
+    void addBlock(uint64_t k1, uint64_t k2)
+    {
+        k1 *= C1;
+        k1 = rotl(k1, 31);
+        k1 *= C2;
+        m_h1 ^= k1;
+        m_h1 = rotl(m_h1, 27);
+        m_h1 += m_h2;
+        m_h1 = m_h1 * 5 + 0x52dce729;
+
+        k2 *= C2;
+        k2 = rotl(k2, 33);
+        k2 *= C1;
+        m_h2 ^= k2;
+        m_h2 = rotl(m_h2, 31);
+        m_h2 += m_h1;
+        m_h2 = m_h2 * 5 + 0x38495ab5;
+    }
+
+    void addWord(uint64_t word)
+    {
+        if (m_hasPending)
+            addBlock(m_pending, word);
+        else
+            m_pending = word;
+        m_hasPending = !m_hasPending;
+        m_length += sizeof(word);
+    }
+
+public:
+    using Digest = std::pair<uint64_t, uint64_t>;
+
+    void add(uint64_t value) { addWord(value); }
+
+    void add(std::string_view text) { add(text.data(), text.size()); }
+
+    void add(const void* data, size_t size)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+
+        // The size is hashed first, so that ranges ending in zero bytes don't
+        // collide with shorter ones.
+        addWord(size);
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            addWord(word);
+        }
+        if (i < size) {
+            uint64_t word = 0;
+            std::memcpy(&word, bytes + i, size - i);
+            addWord(word);
+        }
+    }
+
+    Digest digest() const
+    {
+        auto h1 = m_h1;
+        auto h2 = m_h2;
+        if (m_hasPending)
+            h1 ^= rotl(m_pending * C1, 31) * C2;
+
+        h1 ^= m_length;
+        h2 ^= m_length;
+        h1 += h2;
+        h2 += h1;
+        h1 = fmix(h1);
+        h2 = fmix(h2);
+        h1 += h2;
+        h2 += h1;
+        return { h1, h2 };
+    }
+};
+
+/**
+ * Process-wide store of immutable objects, keyed by a hash of the content
+ * they were built from, so that views of the same content share one copy.
+ *
+ * The store only holds weak references: an object lives for as long as some
+ * view is using it, and expired entries are dropped as new ones are added.
+ */
+template <typename T>
+class ContentStore {
+    mutable std::mutex m_lock;
+    std::map<ContentHash::Digest, std::weak_ptr<const T>> m_entries;
+
+public:
+    /**
+     * Get the live object for a key, if there is one.
+     */
+    std::shared_ptr<const T> find(const ContentHash::Digest& key) const
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        if (auto it = m_entries.find(key); it != m_entries.end())
+            return it->second.lock();
+        return nullptr;
+    }
+
+    /**
+     * Add an object for a key. If another live object was added for the same
+     * key in the meantime, that one is returned instead, so every user of
+     * the content ends up sharing it.
+     */
+    std::shared_ptr<const T> insert(const ContentHash::Digest& key, std::shared_ptr<const T> value)
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        for (auto it = m_entries.begin(); it != m_entries.end();)
+            it = it->second.expired() ? m_entries.erase(it) : std::next(it);
+
+        auto& entry = m_entries[key];
+        if (auto existing = entry.lock())
+            return existing;
+
+        entry = value;
+        return value;
+    }
+
+    /**
+     * Get the number of live objects in the store.
+     */
+    size_t size() const
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        size_t count = 0;
+        for (const auto& [key, value] : m_entries)
+            count += !value.expired();
+        return count;
+    }
+};
@@ -7,54 +7,22 @@
 
 #include "DataRenderers.h"
 
-#include <cinttypes>
-#include <cstdio>
+#include "GlobalState.h"
 
 using namespace BinaryNinja;
 
-/**
- * Get the appropriate token type for a pointer to a given symbol.
- */
-BNInstructionTextTokenType tokenTypeForSymbol(Ref<Symbol> symbol)
-{
-    switch (symbol->GetType()) {
-    case DataSymbol:
-        return DataSymbolToken;
-    case FunctionSymbol:
-        return CodeSymbolToken;
-    default:
-        return CodeRelativeAddressToken;
-    }
-}
-
 /**
  * Get a line for a given pointer.
  */
 DisassemblyTextLine lineForPointer(BinaryView* bv, uint64_t pointer,
     uint64_t address, const std::vector<InstructionTextToken>& prefix)
 {
-    std::string tokenText = "???";
-    auto tokenType = CodeRelativeAddressToken;
-
-    Ref<Symbol> symbol = bv->GetSymbolByAddress(pointer);
-    if (pointer == 0 || pointer == bv->GetStart()) {
-        tokenText = "NULL";
-        tokenType = KeywordToken;
-    } else if (symbol) {
-        tokenText = symbol->GetFullName();
-        tokenType = tokenTypeForSymbol(symbol);
-    } else {
-        char addressBuffer[32];
-        snprintf(addressBuffer, sizeof(addressBuffer), "0x%" PRIx64, pointer);
-
-        tokenText = std::string(addressBuffer);
-        tokenType = CodeRelativeAddressToken;
-    }
+    const auto token = GlobalState::pointerTokenCache(bv)->token(bv, pointer);
 
     DisassemblyTextLine line;
     line.addr = address;
     line.tokens = prefix;
-    line.tokens.emplace_back(tokenType, tokenText, pointer);
+    line.tokens.emplace_back(token->type, token->text, pointer);
 
     return { line };
 }
@@ -62,8 +30,11 @@ DisassemblyTextLine lineForPointer(BinaryView* bv, uint64_t pointer,
 /**
  * Checks if the deepest type in the data renderer context is a named type with
  * the given name.
+ *
+ * The name is compared as a qualified name, so it isn't joined into a string
+ * for every item the renderer is asked about.
  */
-bool isType(const DataRendererContext& context, const std::string& name)
+bool isType(const DataRendererContext& context, const QualifiedName& name)
 {
     if (context.empty())
         return false;
@@ -72,7 +43,7 @@ bool isType(const DataRendererContext& context, const std::string& name)
     if (!deepestType->IsNamedTypeRefer())
         return false;
 
-    return deepestType->GetTypeName().GetString() == name;
+    return deepestType->GetTypeName() == name;
 }
 
 /* ---- Relative Pointer ---------------------------------------------------- */
@@ -80,7 +51,8 @@ bool isType(const DataRendererContext& context, const std::string& name)
 bool RelativePointerDataRenderer::IsValidForData(BinaryView* bv, uint64_t address,
     Type* type, DataRendererContext& context)
 {
-    return isType(context, "rptr_t");
+    static const QualifiedName relativePointerName("rptr_t");
+    return isType(context, relativePointerName);
 }
 
 std::vector<DisassemblyTextLine> RelativePointerDataRenderer::GetLinesForData(
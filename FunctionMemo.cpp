@@ -0,0 +1,32 @@
+#include "FunctionMemo.h"
+
+std::shared_ptr<const FunctionRewrites> FunctionMemo::find(uint64_t start, const ContentHash::Digest& fingerprint)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    const auto* rewrites = m_functions.find(start);
+    if (!rewrites || (*rewrites)->fingerprint != fingerprint)
+        return nullptr;
+    return *rewrites;
+}
+
+void FunctionMemo::insert(uint64_t start, std::shared_ptr<const FunctionRewrites> rewrites)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_functions.insert(start, std::move(rewrites));
+}
+
+size_t FunctionMemo::memoryUsage()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    // Each entry is a list node and an index node, each with two pointers of
+    // overhead, plus a bucket and the shared pointer's control block.
+    constexpr size_t EntryBytes
+        = 2 * sizeof(uint64_t) + sizeof(std::shared_ptr<const FunctionRewrites>) + 7 * sizeof(void*);
+    size_t bytes = m_functions.capacity() * sizeof(void*);
+    m_functions.forEach([&](uint64_t, const std::shared_ptr<const FunctionRewrites>& rewrites) {
+        bytes += EntryBytes + rewrites->memoryUsage();
+    });
+    return bytes;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "BinaryNinja.h"
+#include "Capture.h"
+#include "ContentStore.h"
+#include "LruCache.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * Changes the workflow made to a function, along with a fingerprint of the
+ * calls and register assignments, lookup tables and settings they were
+ * decided from.
+ */
+struct FunctionRewrites {
+    /**
+     * Call type applied to the call at an address.
+     */
+    struct CallType {
+        uint64_t address;
+        TypeRef type;
+    };
+
+    /**
+     * Instruction replaced with a direct call to `target`, or with a CFString
+     * reference to the string at `target`.
+     */
+    struct Replacement {
+        size_t insnIndex;
+        uint64_t target;
+        bool isCFString;
+    };
+
+    ContentHash::Digest fingerprint;
+    std::vector<CallType> callTypes;
+    std::vector<Replacement> replacements;
+
+    /**
+     * Instructions recorded for the function if capturing, so a memo hit can
+     * be recorded with them too.
+     */
+    bool isCaptured = false;
+    std::vector<Capture::Instruction> captured;
+
+    /**
+     * Get the approximate number of heap bytes used by the rewrites,
+     * excluding the types themselves, which are owned by the core.
+     */
+    size_t memoryUsage() const
+    {
+        size_t bytes = sizeof(*this) + callTypes.capacity() * sizeof(CallType)
+            + replacements.capacity() * sizeof(Replacement) + captured.capacity() * sizeof(Capture::Instruction);
+        for (const auto& insn : captured)
+            bytes += insn.selector.capacity();
+        return bytes;
+    }
+};
+
+/**
+ * Per-view memo of the rewrites made to each function, keyed by the
+ * function's start address.
+ *
+ * Functions are analyzed again whenever something they depend on changes,
+ * which usually leaves their IL as it was. The fingerprint is taken while
+ * scanning a function for candidates, before any call site is resolved, so if
+ * it matches, the previous rewrites can be applied again as they are, without
+ * the dataflow queries, selector reads, type building and implementation
+ * lookups they came from. Only functions with call sites are remembered.
+ */
+class FunctionMemo {
+    /**
+     * Maximum number of functions remembered; most of the candidate
+     * functions of a large binary.
+     */
+    static constexpr size_t Capacity = 65536;
+
+    std::mutex m_lock;
+    LruCache<uint64_t, std::shared_ptr<const FunctionRewrites>> m_functions { Capacity };
+
+public:
+    /**
+     * Get the rewrites made to the function at `start`, if they were decided
+     * from inputs with the given fingerprint.
+     */
+    std::shared_ptr<const FunctionRewrites> find(uint64_t start, const ContentHash::Digest& fingerprint);
+
+    /**
+     * Remember the rewrites made to the function at `start`, replacing any
+     * made earlier.
+     */
+    void insert(uint64_t start, std::shared_ptr<const FunctionRewrites>);
+
+    /**
+     * Get the approximate number of heap bytes used by the memo.
+     */
+    size_t memoryUsage();
+};
@@ -7,26 +7,212 @@
 
 #include "GlobalState.h"
 
+#include "Constants.h"
+#include "ContentStore.h"
+#include "Performance.h"
+#include "ViewRegistry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <mutex>
 #include <set>
-#include <shared_mutex>
-#include <unordered_map>
 
-static std::unordered_map<BinaryViewID, MessageHandler*> g_messageHandlers;
-static std::shared_mutex g_messageHandlerLock;
-static std::unordered_map<BinaryViewID, SharedAnalysisInfo> g_viewInfos;
-static std::shared_mutex g_viewInfoLock;
-static std::set<BinaryViewID> g_ignoredViews;
+/**
+ * Analysis info for a view, along with the state needed to make sure only one
+ * thread builds it at a time.
+ *
+ * The current info is swapped atomically, so readers never take the lock;
+ * it is only held to build or rebase the info.
+ */
+struct AnalysisInfoSlot {
+    std::mutex lock;
+    std::condition_variable ready;
+    bool isBuilding = false;
+    SharedAnalysisInfo info;
+
+    SharedAnalysisInfo current() const { return std::atomic_load_explicit(&info, std::memory_order_acquire); }
+    void publish(SharedAnalysisInfo value) { std::atomic_store_explicit(&info, std::move(value), std::memory_order_release); }
+};
+
+/**
+ * All plugin state kept for a single view.
+ */
+struct ViewState {
+    std::atomic<bool> isIgnored = false;
+    PerformanceCounters performance;
+
+    // Pending performance report, if any, and the view it will be made for.
+    // The event is cancelled if that view is destroyed first.
+    std::atomic<bool> isReportScheduled = false;
+    std::mutex reportLock;
+    BinaryNinja::BinaryView* reportView = nullptr;
+    BinaryNinja::Ref<BinaryNinja::AnalysisCompletionEvent> reportEvent;
+
+    std::once_flag messageHandlerOnce;
+    std::unique_ptr<MessageHandler> messageHandler;
+    std::atomic<bool> hasMessageHandler = false;
+
+    SelectorTable selectorTable;
+    CallTypeCache callTypeCache;
+    PointerTokenCache pointerTokenCache;
+    FunctionMemo functionMemo;
+    AnalysisInfoSlot analysisInfo;
 
+    // View the caches above are registered with for change notifications.
+    std::mutex notificationLock;
+    BinaryNinja::BinaryView* notificationView = nullptr;
+    std::atomic<bool> hasNotificationView = false;
+
+    std::once_flag captureOnce;
+
+    // Image base and call type generation the selector and call type caches
+    // were last prepared for (see `GlobalState::prepareMethodCalls`). The
+    // lock only serializes starting a preparation.
+    std::mutex methodCallPreparationLock;
+    bool isPreparingMethodCalls = false;
+    std::atomic<bool> hasPreparedMethodCalls = false;
+    std::atomic<uint64_t> preparedImageBase = 0;
+    std::atomic<uint64_t> preparedCallTypeGeneration = 0;
+};
+
+static ViewRegistry<ViewState> g_viewStates;
+static std::atomic<uint64_t> g_analysisInfoBlockedTime = 0;
+
+/**
+ * Register a view state's caches for change notifications from `bv`.
+ *
+ * Every view of a file shares one state, but only the analysis view sees the
+ * type and symbol changes the caches depend on, so the Raw view is skipped and
+ * registration waits for the first analysis view to ask for the state.
+ */
+static void registerNotifications(ViewState& state, BinaryViewRef bv)
+{
+    if (bv->GetTypeName() == "Raw")
+        return;
+
+    std::lock_guard<std::mutex> lock(state.notificationLock);
+    if (state.notificationView)
+        return;
+
+    bv->RegisterNotification(&state.callTypeCache);
+    bv->RegisterNotification(&state.pointerTokenCache);
+    state.notificationView = bv.GetPtr();
+    state.hasNotificationView.store(true, std::memory_order_release);
+}
+
+/**
+ * Undo `registerNotifications` if the caches are registered with `view`, or
+ * with any view if `view` is null.
+ */
+static void unregisterNotifications(ViewState& state, BinaryNinja::BinaryView* view = nullptr)
+{
+    std::lock_guard<std::mutex> lock(state.notificationLock);
+    if (!state.notificationView || (view && state.notificationView != view))
+        return;
+
+    state.notificationView->UnregisterNotification(&state.callTypeCache);
+    state.notificationView->UnregisterNotification(&state.pointerTokenCache);
+    state.notificationView = nullptr;
+}
+
+/**
+ * Get the state for a view, creating it on first use.
+ */
+static ViewState& viewState(BinaryViewRef bv, BinaryViewID id)
+{
+    auto& state = *g_viewStates.findOrCreate(id, []() { return std::make_unique<ViewState>(); });
+    if (!state.hasNotificationView.load(std::memory_order_acquire))
+        registerNotifications(state, bv);
+    return state;
+}
 
 MessageHandler* GlobalState::messageHandler(BinaryViewRef bv)
 {
-    std::unique_lock<std::shared_mutex> lock(g_messageHandlerLock);
-    auto messageHandler = g_messageHandlers.find(id(bv));
-    if (messageHandler != g_messageHandlers.end())
-        return messageHandler->second;
-    auto newMessageHandler = new MessageHandler(bv);
-    g_messageHandlers[id(bv)] = newMessageHandler;
-    return newMessageHandler;
+    auto& state = viewState(bv, id(bv));
+    std::call_once(state.messageHandlerOnce, [&]() {
+        state.messageHandler = std::make_unique<MessageHandler>(bv);
+        state.hasMessageHandler.store(true, std::memory_order_release);
+    });
+    return state.messageHandler.get();
+}
+
+void GlobalState::refreshMethodCalls(BinaryViewRef bv, const AnalysisInfo& info)
+{
+    auto& state = viewState(bv, id(bv));
+    if (!state.hasPreparedMethodCalls.load(std::memory_order_acquire))
+        return;
+    if (state.preparedImageBase.load(std::memory_order_relaxed) == info.imageBase
+        && state.preparedCallTypeGeneration.load(std::memory_order_relaxed) == state.callTypeCache.generation())
+        return;
+
+    prepareMethodCalls(bv);
+}
+
+SelectorTable* GlobalState::selectorTable(BinaryViewRef bv)
+{
+    return &viewState(bv, id(bv)).selectorTable;
+}
+
+CallTypeCache* GlobalState::callTypeCache(BinaryViewRef bv)
+{
+    return &viewState(bv, id(bv)).callTypeCache;
+}
+
+PointerTokenCache* GlobalState::pointerTokenCache(BinaryViewRef bv)
+{
+    return &viewState(bv, id(bv)).pointerTokenCache;
+}
+
+FunctionMemo* GlobalState::functionMemo(BinaryViewRef bv)
+{
+    return &viewState(bv, id(bv)).functionMemo;
+}
+
+Capture::Writer* GlobalState::captureWriter(BinaryViewRef bv)
+{
+    static const auto writer = []() -> std::unique_ptr<Capture::Writer> {
+        const auto path = std::getenv("WORKFLOW_OBJC_CAPTURE");
+        if (!path || !*path)
+            return nullptr;
+
+        auto result = std::make_unique<Capture::Writer>(path);
+        if (!result->isOpen()) {
+            BinaryNinja::LogRegistry::GetLogger(PluginLoggerName)->LogError("Failed to open capture file '%s'", path);
+            return nullptr;
+        }
+        return result;
+    }();
+    if (!writer)
+        return nullptr;
+
+    auto& state = viewState(bv, id(bv));
+    std::call_once(state.captureOnce, [&]() {
+        Capture::ViewRecord view;
+        view.session = id(bv);
+        messageHandler(bv)->getCallTargets().forEach(
+            [&](uint64_t address, CallTargetKind kind) { view.callTargets.emplace_back(address, kind); });
+
+        if (const auto info = analysisInfo(bv)) {
+            const auto& tables = *info->tables;
+            view.imageBase = info->imageBase;
+            tables.cfStrings.forEach([&](uint64_t address, uint64_t string) { view.cfStrings.emplace_back(address, string); });
+            tables.selectorStubs.forEach(
+                [&](uint64_t stub, uint64_t selector) { view.selectorStubs.emplace_back(stub, selector); });
+            tables.selRefToImp.serialize(view.selectorIndexes);
+            tables.selToImp.serialize(view.selectorIndexes);
+            tables.selectorStrings.serialize(view.selectorStrings);
+            tables.classes.serialize(view.classes);
+            tables.methodTypes.serialize(view.methodTypes);
+        }
+
+        writer->write(view);
+    });
+
+    return writer.get();
 }
 
 BinaryViewID GlobalState::id(BinaryViewRef bv)
@@ -36,56 +222,887 @@ BinaryViewID GlobalState::id(BinaryViewRef bv)
 
 void GlobalState::addIgnoredView(BinaryViewRef bv)
 {
-    g_ignoredViews.insert(id(std::move(bv)));
+    viewState(bv, id(bv)).isIgnored.store(true, std::memory_order_relaxed);
 }
 
 bool GlobalState::viewIsIgnored(BinaryViewRef bv)
 {
-    return g_ignoredViews.count(id(std::move(bv))) > 0;
+    auto state = g_viewStates.find(id(bv));
+    return state && state->isIgnored.load(std::memory_order_relaxed);
 }
 
-SharedAnalysisInfo GlobalState::analysisInfo(BinaryViewRef data)
+PerformanceCounters& GlobalState::performanceCounters(BinaryViewRef bv)
+{
+    return viewState(bv, id(bv)).performance;
+}
+
+void GlobalState::reportPerformance(BinaryViewRef bv)
+{
+    auto& state = viewState(bv, id(bv));
+    const auto sample = state.performance.snapshot();
+
+    // Reported after every round of analysis, so only logged at debug level;
+    // the counters are always available from the view's metadata.
+    const auto log = BinaryNinja::LogRegistry::GetLogger(PluginLoggerName);
+    log->LogDebug("Objective-C workflow: %s selectorCacheHits=%llu selectorCacheMisses=%llu",
+        PerformanceCounters::format(sample).c_str(),
+        static_cast<unsigned long long>(state.selectorTable.hits()),
+        static_cast<unsigned long long>(state.selectorTable.misses()));
+
+    std::map<std::string, BinaryNinja::Ref<BinaryNinja::Metadata>> values;
+    for (size_t i = 0; i < CounterCount; ++i)
+        values[PerformanceCounters::name(static_cast<Counter>(i))] = new BinaryNinja::Metadata(sample.counters[i]);
+    for (size_t i = 0; i < PhaseCount; ++i) {
+        std::string name = PerformanceCounters::name(static_cast<Phase>(i));
+        values[name + "TotalNs"] = new BinaryNinja::Metadata(sample.phaseTotal[i]);
+        values[name + "MaxNs"] = new BinaryNinja::Metadata(sample.phaseMax[i]);
+    }
+    values["selectorCacheHits"] = new BinaryNinja::Metadata(state.selectorTable.hits());
+    values["selectorCacheMisses"] = new BinaryNinja::Metadata(state.selectorTable.misses());
+
+    bv->StoreMetadata(MetadataKey::PerformanceCounters, new BinaryNinja::Metadata(values), true);
+}
+
+void GlobalState::scheduleAnalysisReport(BinaryViewRef bv)
+{
+    auto& state = viewState(bv, id(bv));
+    if (state.isReportScheduled.exchange(true, std::memory_order_relaxed))
+        return;
+
+    // Completion events only fire once, so the flag is cleared to let the
+    // next round of analysis schedule another report. The callback holds the
+    // view weakly, through the state's pending report, which is cleared and
+    // the event cancelled if the view is destroyed before analysis completes
+    // (see `ViewStateDestructor`).
+    const auto viewId = id(bv);
+    BinaryNinja::BinaryView* view = bv;
+    std::lock_guard<std::mutex> lock(state.reportLock);
+    state.reportView = view;
+    state.reportEvent = bv->AddAnalysisCompletionEvent([viewId, view]() {
+        auto* state = g_viewStates.find(viewId);
+        if (!state)
+            return;
+
+        std::lock_guard<std::mutex> lock(state->reportLock);
+        if (state->reportView != view)
+            return;
+
+        state->reportView = nullptr;
+        state->reportEvent = nullptr;
+        state->isReportScheduled.store(false, std::memory_order_relaxed);
+        reportPerformance(view);
+    });
+}
+
+/**
+ * Cancel a view state's pending performance report if it is for `view`.
+ */
+static void cancelAnalysisReport(ViewState& state, BinaryNinja::BinaryView* view)
 {
+    std::lock_guard<std::mutex> lock(state.reportLock);
+    if (state.reportView != view)
+        return;
+
+    if (state.reportEvent)
+        state.reportEvent->Cancel();
+    state.reportEvent = nullptr;
+    state.reportView = nullptr;
+    state.isReportScheduled.store(false, std::memory_order_relaxed);
+}
+
+/**
+ * Get every section with the given name. Images from a shared cache prefix
+ * their section names with the image name, so those are matched too.
+ */
+static std::vector<BinaryNinja::Ref<BinaryNinja::Section>> sectionsNamed(BinaryViewRef data, const std::string& name)
+{
+    const auto suffix = "::" + name;
+
+    std::vector<BinaryNinja::Ref<BinaryNinja::Section>> results;
+    for (const auto& section : data->GetSections()) {
+        const auto sectionName = section->GetName();
+        if (sectionName == name
+            || (sectionName.size() > suffix.size()
+                && sectionName.compare(sectionName.size() - suffix.size(), suffix.size(), suffix) == 0))
+            results.push_back(section);
+    }
+
+    return results;
+}
+
+/**
+ * Sections whose contents the analysis tables are built from.
+ */
+constexpr const char* AnalysisTableSections[] = { "__objc_methname", "__objc_selrefs", "__objc_classlist",
+    "__objc_catlist", "__objc_const", "__objc_data", "__objc_methlist", "__objc_methtype", "__cfstring",
+    "__objc_stubs" };
+
+/**
+ * Contents of a view's `AnalysisTableSections`, read once and used both to
+ * find tables to share and to build new ones.
+ */
+class SectionSnapshot {
+public:
+    struct Section {
+        std::string name;
+        uint64_t start;
+        BinaryNinja::DataBuffer contents;
+
+        const uint8_t* bytes() const { return static_cast<const uint8_t*>(contents.GetData()); }
+        size_t size() const { return contents.GetLength(); }
+    };
+
+private:
+    std::map<std::string, std::vector<Section>, std::less<>> m_sections;
+
+public:
+    explicit SectionSnapshot(BinaryViewRef data)
     {
-        std::shared_lock<std::shared_mutex> lock(g_viewInfoLock);
-        if (auto it = g_viewInfos.find(id(data)); it != g_viewInfos.end())
-            if (data->GetStart() == it->second->imageBase)
-                return it->second;
+        for (const auto* name : AnalysisTableSections) {
+            auto& sections = m_sections[name];
+            for (const auto& section : sectionsNamed(data, name)) {
+                const auto start = section->GetStart();
+                sections.push_back({ section->GetName(), start, data->ReadBuffer(start, section->GetLength()) });
+            }
+        }
     }
 
-    std::unique_lock<std::shared_mutex> lock(g_viewInfoLock);
-    SharedAnalysisInfo info = std::make_shared<AnalysisInfo>();
-    info->imageBase = data->GetStart();
+    /**
+     * Get the sections with one of the names in `AnalysisTableSections`.
+     */
+    const std::vector<Section>& named(std::string_view name) const { return m_sections.find(name)->second; }
+};
+
+/**
+ * Read a little-endian pointer of the given width.
+ */
+static uint64_t readPointer(const uint8_t* data, size_t width)
+{
+    uint64_t value = 0;
+    std::memcpy(&value, data, std::min(width, sizeof(value)));
+    return value;
+}
+
+/**
+ * Index every CFString in the view's `__cfstring` sections, relative to the
+ * given image base.
+ */
+static CFStringIndex buildCFStringIndex(BinaryViewRef data, const SectionSnapshot& sections, uint64_t imageBase)
+{
+    // A CFString is four pointer-sized fields: the class, the flags, the
+    // backing string pointer, and the length.
+    const size_t pointerSize = data->GetAddressSize();
+    const size_t stride = 4 * pointerSize;
+    const size_t stringOffset = 2 * pointerSize;
+
+    std::vector<std::pair<uint64_t, uint64_t>> entries;
+    for (const auto& section : sections.named("__cfstring")) {
+        for (size_t offset = 0; offset + stride <= section.size(); offset += stride) {
+            if (auto string = readPointer(section.bytes() + offset + stringOffset, pointerSize))
+                entries.emplace_back(section.start + offset - imageBase, string - imageBase);
+        }
+    }
+
+    return CFStringIndex(std::move(entries));
+}
+
+/**
+ * Snapshot the view's selector names and selector references, relative to
+ * the given image base. Shared cache images name their sections with an
+ * image prefix, which `sectionsNamed` accounts for.
+ */
+static SelectorStrings buildSelectorStrings(BinaryViewRef data, const SectionSnapshot& sections, uint64_t imageBase)
+{
+    SelectorStrings::Builder builder;
+    for (const auto& section : sections.named("__objc_methname"))
+        builder.addNames(section.start - imageBase, section.bytes(), section.size());
+
+    const size_t pointerSize = data->GetAddressSize();
+    for (const auto& section : sections.named("__objc_selrefs")) {
+        for (size_t offset = 0; offset + pointerSize <= section.size(); offset += pointerSize) {
+            if (auto name = readPointer(section.bytes() + offset, pointerSize))
+                builder.addRef(section.start + offset - imageBase, name - imageBase);
+        }
+    }
+
+    return builder.build();
+}
 
-    if (auto objcStubs = data->GetSectionByName("__objc_stubs"))
+/**
+ * Reads the Objective-C runtime structures that make up classes and
+ * categories, which are spread across the view rather than packed into one
+ * section. Addresses taken and returned are absolute.
+ */
+class RuntimeReader {
+    BinaryViewRef m_data;
+    size_t m_pointerSize;
+    uint64_t m_imageBase;
+    const SelectorStrings& m_strings;
+    MethodTypeIndex::Builder& m_types;
+
+    /**
+     * Flag set in a method list's entry size when its entries are 32-bit
+     * offsets rather than pointers.
+     */
+    static constexpr uint32_t RelativeMethodsFlag = 0x80000000;
+
+    /**
+     * Flag set in a shared cache method list when its selectors are offsets
+     * from the cache's selector base, which isn't known here.
+     */
+    static constexpr uint32_t SelectorOffsetsFlag = 0x40000000;
+
+    static constexpr uint32_t EntrySizeMask = 0xfffc;
+
+public:
+    struct ClassData {
+        uint64_t isa = 0;
+        uint64_t superclass = 0;
+        ClassMethodIndex::Methods methods;
+    };
+
+    /**
+     * @param types Builder the type encoding of every method read is added to
+     */
+    RuntimeReader(BinaryViewRef data, uint64_t imageBase, const SelectorStrings& strings, MethodTypeIndex::Builder& types)
+        : m_data(data)
+        , m_pointerSize(data->GetAddressSize())
+        , m_imageBase(imageBase)
+        , m_strings(strings)
+        , m_types(types)
     {
-        info->objcStubsStartEnd = {objcStubs->GetStart(), objcStubs->GetEnd()};
-        info->hasObjcStubs = true;
     }
 
-    auto meta = data->QueryMetadata("Objective-C");
-    if (!meta)
+    size_t pointerSize() const { return m_pointerSize; }
+
+    std::optional<uint64_t> pointer(uint64_t address) const
     {
-        g_viewInfos[id(data)] = info;
-        return info;
+        uint8_t bytes[sizeof(uint64_t)];
+        if (m_data->Read(bytes, address, m_pointerSize) != m_pointerSize)
+            return std::nullopt;
+        return readPointer(bytes, m_pointerSize);
     }
 
+    /**
+     * Read the (image-relative selector name, implementation) pairs in the
+     * method list at the given address.
+     */
+    ClassMethodIndex::Methods methodList(uint64_t address) const
+    {
+        ClassMethodIndex::Methods methods;
+
+        // Lists with the low bit set are lists of lists, which only occur in
+        // the shared cache.
+        if (!address || (address & 1))
+            return methods;
+
+        uint32_t header[2];
+        if (m_data->Read(header, address, sizeof(header)) != sizeof(header))
+            return methods;
+
+        const auto [flags, count] = std::make_pair(header[0], header[1]);
+        const bool isRelative = flags & RelativeMethodsFlag;
+        const size_t entrySize = flags & EntrySizeMask;
+        if ((flags & SelectorOffsetsFlag) || entrySize < (isRelative ? 12 : 3 * m_pointerSize))
+            return methods;
+
+        const auto entriesStart = address + sizeof(header);
+        const auto contents = m_data->ReadBuffer(entriesStart, static_cast<size_t>(count) * entrySize);
+        if (contents.GetLength() != static_cast<size_t>(count) * entrySize)
+            return methods;
+
+        const auto* bytes = static_cast<const uint8_t*>(contents.GetData());
+        methods.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            const auto* entry = bytes + i * entrySize;
+            const auto entryAddress = entriesStart + i * entrySize;
+
+            // Relative entries hold the offset of a selector reference, of
+            // the types and of the implementation from each field's own
+            // address.
+            std::optional<uint64_t> name;
+            uint64_t types;
+            uint64_t implementation;
+            if (isRelative) {
+                int32_t nameOffset, typesOffset, implementationOffset;
+                std::memcpy(&nameOffset, entry, sizeof(nameOffset));
+                std::memcpy(&typesOffset, entry + 4, sizeof(typesOffset));
+                std::memcpy(&implementationOffset, entry + 8, sizeof(implementationOffset));
+                name = m_strings.nameForRef(entryAddress + nameOffset - m_imageBase);
+                types = typesOffset ? entryAddress + 4 + typesOffset : 0;
+                implementation = implementationOffset ? entryAddress + 8 + implementationOffset : 0;
+            } else {
+                if (const auto selector = readPointer(entry, m_pointerSize))
+                    name = selector - m_imageBase;
+                types = readPointer(entry + m_pointerSize, m_pointerSize);
+                implementation = readPointer(entry + 2 * m_pointerSize, m_pointerSize);
+            }
+
+            if (name && types)
+                m_types.addMethod(*name, types - m_imageBase);
+            if (name && implementation)
+                methods.emplace_back(*name, implementation - m_imageBase);
+        }
+
+        return methods;
+    }
+
+    /**
+     * Read the class (or metaclass) at the given address along with its own
+     * methods.
+     */
+    std::optional<ClassData> classAt(uint64_t address) const
+    {
+        // The class is five pointers: the isa, the superclass, two for the
+        // method cache, then the read-only data with flags in its low bits.
+        const auto isa = pointer(address);
+        const auto superclass = pointer(address + m_pointerSize);
+        const auto data = pointer(address + 4 * m_pointerSize);
+        if (!isa || !superclass || !data)
+            return std::nullopt;
+
+        const auto roAddress = *data & (m_pointerSize == 8 ? 0x00007ffffffffff8ULL : ~3ULL);
+
+        // The read-only data starts with three 32-bit fields, plus a
+        // reserved one on 64-bit, then the ivar layout, name, and methods.
+        const size_t roHeaderSize = m_pointerSize == 8 ? 16 : 12;
+        const auto baseMethods = pointer(roAddress + roHeaderSize + 2 * m_pointerSize);
+        if (!baseMethods)
+            return std::nullopt;
+
+        ClassData result;
+        result.isa = *isa;
+        result.superclass = *superclass;
+        result.methods = methodList(*baseMethods);
+        return result;
+    }
+};
+
+/**
+ * Flatten the method tables of every class, metaclass, and category in the
+ * view's `__objc_classlist` and `__objc_catlist` sections, relative to the
+ * given image base.
+ *
+ * @param types Builder the type encoding of every method is added to
+ */
+static ClassMethodIndex buildClassMethodIndex(BinaryViewRef data, const SectionSnapshot& sections, uint64_t imageBase,
+    const SelectorStrings& strings, MethodTypeIndex::Builder& types)
+{
+    const RuntimeReader reader(data, imageBase, strings, types);
+    const auto pointerSize = reader.pointerSize();
+    auto relative = [&](uint64_t address) { return address ? address - imageBase : 0; };
+
+    auto forEachPointer = [&](const char* sectionName, auto&& visitor) {
+        for (const auto& section : sections.named(sectionName)) {
+            for (size_t offset = 0; offset + pointerSize <= section.size(); offset += pointerSize) {
+                if (auto address = readPointer(section.bytes() + offset, pointerSize))
+                    visitor(address);
+            }
+        }
+    };
+
+    ClassMethodIndex::Builder builder;
+    forEachPointer("__objc_classlist", [&](uint64_t address) {
+        auto cls = reader.classAt(address);
+        if (!cls)
+            return;
+
+        if (auto metaclass = cls->isa ? reader.classAt(cls->isa) : std::nullopt)
+            builder.addClass(cls->isa - imageBase, relative(metaclass->superclass), 0, std::move(metaclass->methods));
+        builder.addClass(address - imageBase, relative(cls->superclass), relative(cls->isa), std::move(cls->methods));
+    });
+
+    // A category is its name, then its class, followed by the instance and
+    // class method lists. Categories on classes outside the image have no
+    // class pointer here and are skipped.
+    forEachPointer("__objc_catlist", [&](uint64_t address) {
+        const auto cls = reader.pointer(address + pointerSize);
+        const auto instanceMethods = reader.pointer(address + 2 * pointerSize);
+        const auto classMethods = reader.pointer(address + 3 * pointerSize);
+        if (!cls || !*cls || !instanceMethods || !classMethods)
+            return;
+
+        builder.addCategory(*cls - imageBase, reader.methodList(*instanceMethods));
+        if (const auto metaclass = reader.pointer(*cls); metaclass && *metaclass)
+            builder.addCategory(*metaclass - imageBase, reader.methodList(*classMethods));
+    });
+
+    return builder.build();
+}
+
+/**
+ * Decode the selector loaded by every stub in the view's `__objc_stubs`
+ * sections, relative to the given image base. Only ARM64 has such stubs.
+ *
+ * @param strings The view's image-relative selector snapshot, used to
+ * resolve the selector reference loaded by each stub
+ */
+static SelectorStubIndex buildSelectorStubIndex(
+    BinaryViewRef data, const SectionSnapshot& sections, uint64_t imageBase, const SelectorStrings& strings)
+{
+    const auto arch = data->GetDefaultArchitecture();
+    if (!arch || arch->GetName() != "aarch64")
+        return {};
+
+    std::vector<std::pair<uint64_t, uint64_t>> entries;
+    for (const auto& section : sections.named("__objc_stubs")) {
+        const auto decoded = decodeArm64SelectorStubs(section.start, section.bytes(), section.size());
+        for (const auto& [stub, selRef] : decoded) {
+            if (auto selector = strings.nameForRef(selRef - imageBase))
+                entries.emplace_back(stub - imageBase, *selector);
+        }
+    }
+
+    return SelectorStubIndex(std::move(entries));
+}
+
+std::vector<uint64_t> GlobalState::undecodedSelectorStubs(BinaryViewRef data)
+{
+    const auto stubSections = sectionsNamed(data, "__objc_stubs");
+    if (stubSections.empty())
+        return {};
+
+    std::vector<std::pair<uint64_t, uint64_t>> stubRanges;
+    for (const auto& section : stubSections)
+        stubRanges.emplace_back(section->GetStart(), section->GetEnd());
+    const AddressRangeSet stubs(std::move(stubRanges));
+
+    // A stub counts as decoded if it loads from a selector reference, which
+    // is all that is checked without building the selector snapshot. The few
+    // it accepts that the full stub index doesn't are still marked when they
+    // are analyzed.
+    std::vector<uint64_t> decoded;
+    const auto arch = data->GetDefaultArchitecture();
+    if (arch && arch->GetName() == "aarch64") {
+        std::vector<std::pair<uint64_t, uint64_t>> selRefRanges;
+        for (const auto& section : sectionsNamed(data, "__objc_selrefs"))
+            selRefRanges.emplace_back(section->GetStart(), section->GetEnd());
+        const AddressRangeSet selRefs(std::move(selRefRanges));
+
+        for (const auto& section : stubSections) {
+            const auto contents = data->ReadBuffer(section->GetStart(), section->GetLength());
+            const auto* bytes = static_cast<const uint8_t*>(contents.GetData());
+            for (const auto& [stub, selRef] : decodeArm64SelectorStubs(section->GetStart(), bytes, contents.GetLength()))
+                if (selRefs.contains(selRef))
+                    decoded.push_back(stub);
+        }
+        std::sort(decoded.begin(), decoded.end());
+    }
+
+    std::vector<uint64_t> undecoded;
+    messageHandler(data)->getCallTargets().forEach([&](uint64_t address, CallTargetKind kind) {
+        if (kind == CallTargetKind::SelectorStub && stubs.contains(address)
+            && !std::binary_search(decoded.begin(), decoded.end(), address))
+            undecoded.push_back(address);
+    });
+
+    return undecoded;
+}
+
+/**
+ * Build the filter of addresses a function must reference to need any work,
+ * relative to the given image base.
+ */
+static CandidateFilter buildCandidateFilter(BinaryViewRef data, const MessageHandler& messageHandler, uint64_t imageBase)
+{
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+
+    // Pages are computed on absolute addresses, since that is what ADRP
+    // materializes, and clamped to the image so no range wraps around.
+    auto addRange = [&](uint64_t start, uint64_t end) {
+        auto [pageStart, pageEnd] = CandidateFilter::pageRange(start, end);
+        ranges.emplace_back(std::max(pageStart, imageBase) - imageBase, pageEnd - imageBase);
+    };
+
+    messageHandler.getCallTargets().forEach([&](uint64_t address, CallTargetKind) {
+        addRange(address, address + 1);
+    });
+    for (const auto& name : { "__cfstring", "__objc_stubs" })
+        for (const auto& section : sectionsNamed(data, name))
+            addRange(section->GetStart(), section->GetEnd());
+
+    return CandidateFilter(std::move(ranges));
+}
+
+/**
+ * Header of the selector index blob stored in a view's metadata.
+ *
+ * The blob caches the indexes built from the core's Objective-C metadata, so
+ * reopening a database needs a single metadata read instead of one per
+ * element. It is only trusted if every field matches, including the analysis
+ * tables key of the view it was built for, which covers the Objective-C
+ * sections the core's metadata is parsed from and the metadata's version;
+ * otherwise the indexes are rebuilt and the blob is replaced. The indexes are
+ * image-relative, so the blob stays valid across rebases.
+ */
+struct SelectorIndexHeader {
+    static constexpr uint32_t ExpectedMagic = 0x49534e4f; // "ONSI"
+    static constexpr uint32_t CurrentVersion = 4;
+
+    uint32_t magic = ExpectedMagic;
+    uint32_t version = CurrentVersion;
+    uint64_t tablesKeyLow = 0;
+    uint64_t tablesKeyHigh = 0;
+};
+
+static bool loadSelectorIndexes(BinaryViewRef data, const ContentHash::Digest& tablesKey, AnalysisTables& tables)
+{
+    auto meta = data->QueryMetadata(MetadataKey::SelectorIndex);
+    if (!meta || !meta->IsRaw())
+        return false;
+
+    const auto blob = meta->GetRaw();
+    SelectorIndexHeader header;
+    if (blob.size() < sizeof(header))
+        return false;
+
+    std::memcpy(&header, blob.data(), sizeof(header));
+    if (header.magic != SelectorIndexHeader::ExpectedMagic || header.version != SelectorIndexHeader::CurrentVersion)
+        return false;
+    if (header.tablesKeyLow != tablesKey.first || header.tablesKeyHigh != tablesKey.second)
+        return false;
+
+    const auto* cursor = blob.data() + sizeof(header);
+    const auto* end = blob.data() + blob.size();
+    auto selRefToImp = SelectorImplementationIndex::deserialize(cursor, end);
+    auto selToImp = SelectorImplementationIndex::deserialize(cursor, end);
+    if (!selRefToImp || !selToImp || cursor != end)
+        return false;
+
+    tables.selRefToImp = std::move(*selRefToImp);
+    tables.selToImp = std::move(*selToImp);
+    return true;
+}
+
+static void storeSelectorIndexes(BinaryViewRef data, const ContentHash::Digest& tablesKey, const AnalysisTables& tables)
+{
+    SelectorIndexHeader header;
+    header.tablesKeyLow = tablesKey.first;
+    header.tablesKeyHigh = tablesKey.second;
+    std::vector<uint8_t> blob(sizeof(header));
+    std::memcpy(blob.data(), &header, sizeof(header));
+    tables.selRefToImp.serialize(blob);
+    tables.selToImp.serialize(blob);
+
+    // Stored as auto metadata, since it is derived from the core's own and
+    // can always be rebuilt.
+    data->StoreMetadata(MetadataKey::SelectorIndex, new BinaryNinja::Metadata(blob), true);
+}
+
+/**
+ * Build an image-relative selector index from a metadata array of
+ * (selector, implementations) pairs.
+ */
+static SelectorImplementationIndex buildSelectorIndex(BinaryNinja::Ref<BinaryNinja::Metadata> entries, uint64_t imageBase)
+{
+    SelectorImplementationIndex::Builder builder;
+    for (const auto& selAndImps : entries->GetArray()) {
+        auto imps = selAndImps->GetArray()[1]->GetUnsignedIntegerList();
+        for (auto& imp : imps)
+            imp -= imageBase;
+        builder.add(selAndImps->GetArray()[0]->GetUnsignedInteger() - imageBase, imps);
+    }
+
+    return builder.build();
+}
+
+/**
+ * Hash everything the analysis tables for a view are built from: the
+ * contents of the Objective-C sections and their image-relative placement,
+ * the image-relative call targets, and whether the core's Objective-C
+ * metadata is usable. Views with the same hash build identical tables.
+ */
+static ContentHash::Digest analysisTablesKey(
+    BinaryViewRef data, const SectionSnapshot& sections, const MessageHandler& messageHandler, uint64_t imageBase)
+{
+    ContentHash hash;
+    if (const auto arch = data->GetDefaultArchitecture())
+        hash.add(arch->GetName());
+    hash.add(data->GetAddressSize());
+
+    for (const auto* name : AnalysisTableSections) {
+        for (const auto& section : sections.named(name)) {
+            hash.add(section.name);
+            hash.add(section.start - imageBase);
+            hash.add(section.bytes(), section.size());
+        }
+    }
+
+    std::vector<std::pair<uint64_t, CallTargetKind>> callTargets;
+    messageHandler.getCallTargets().forEach([&](uint64_t address, CallTargetKind kind) {
+        callTargets.emplace_back(address - imageBase, kind);
+    });
+    std::sort(callTargets.begin(), callTargets.end());
+    for (const auto& [address, kind] : callTargets) {
+        hash.add(address);
+        hash.add(static_cast<uint64_t>(kind));
+    }
+
+    const auto meta = data->QueryMetadata("Objective-C");
+    hash.add(meta ? meta->GetKeyValueStore()["version"]->GetUnsignedInteger() : 0);
+
+    return hash.digest();
+}
+
+/**
+ * Build the analysis tables for a view from its sections and Objective-C
+ * metadata.
+ */
+static std::shared_ptr<AnalysisTables> buildAnalysisTables(
+    BinaryViewRef data, const SectionSnapshot& sections, const ContentHash::Digest& key, uint64_t imageBase)
+{
+    auto tables = std::make_shared<AnalysisTables>();
+    tables->cfStrings = buildCFStringIndex(data, sections, imageBase);
+    tables->candidates = buildCandidateFilter(data, *GlobalState::messageHandler(data), imageBase);
+    tables->selectorStrings = buildSelectorStrings(data, sections, imageBase);
+    tables->selectorStubs = buildSelectorStubIndex(data, sections, imageBase, tables->selectorStrings);
+
+    MethodTypeIndex::Builder methodTypes;
+    for (const auto& section : sections.named("__objc_methtype"))
+        methodTypes.addTypes(section.start - imageBase, section.bytes(), section.size());
+    tables->classes = buildClassMethodIndex(data, sections, imageBase, tables->selectorStrings, methodTypes);
+    tables->methodTypes = methodTypes.build(tables->selectorStrings);
+    BinaryNinja::LogDebug("workflow_objc: Class method index has %zu classes and metaclasses with %zu methods, "
+                          "%zu selectors with known types",
+        tables->classes.size(), tables->classes.methodCount(), tables->methodTypes.size());
+
+    std::vector<std::pair<uint64_t, uint64_t>> stubRanges;
+    for (const auto& section : sectionsNamed(data, "__objc_stubs"))
+        stubRanges.emplace_back(section->GetStart() - imageBase, section->GetEnd() - imageBase);
+    tables->objcStubs = AddressRangeSet(std::move(stubRanges));
+
+    auto meta = data->QueryMetadata("Objective-C");
+    if (!meta)
+        return tables;
+
     auto metaKVS = meta->GetKeyValueStore();
     if (metaKVS["version"]->GetUnsignedInteger() != 1)
     {
         BinaryNinja::LogError("workflow_objc: Invalid metadata version received!");
-        g_viewInfos[id(data)] = info;
+        return tables;
+    }
+
+    if (loadSelectorIndexes(data, key, *tables)) {
+        BinaryNinja::LogDebug("workflow_objc: Loaded selector index for %zu keys from the database",
+            tables->selRefToImp.size() + tables->selToImp.size());
+        return tables;
+    }
+
+    tables->selRefToImp = buildSelectorIndex(metaKVS["selRefImplementations"], imageBase);
+    tables->selToImp = buildSelectorIndex(metaKVS["selImplementations"], imageBase);
+
+    BinaryNinja::LogDebug("workflow_objc: Selector index uses %zu bytes for %zu keys (previous layout: ~%zu bytes)",
+        tables->selRefToImp.memoryUsage() + tables->selToImp.memoryUsage(),
+        tables->selRefToImp.size() + tables->selToImp.size(),
+        tables->selRefToImp.legacyMemoryUsage() + tables->selToImp.legacyMemoryUsage());
+
+    storeSelectorIndexes(data, key, *tables);
+    return tables;
+}
+
+/**
+ * Tables for every distinct image content in the process, shared by all
+ * views of that content, such as several databases of one binary or views of
+ * the same shared cache images.
+ */
+static ContentStore<AnalysisTables> g_sharedTables;
+
+static SharedAnalysisInfo buildAnalysisInfo(BinaryViewRef data)
+{
+    const auto imageBase = data->GetStart();
+    SharedAnalysisInfo info = std::make_shared<AnalysisInfo>();
+    info->imageBase = imageBase;
+
+    // The sections are read once, for the key and for building the tables on
+    // a miss.
+    const SectionSnapshot sections(data);
+    const auto key = analysisTablesKey(data, sections, *GlobalState::messageHandler(data), imageBase);
+    if (auto tables = g_sharedTables.find(key)) {
+        BinaryNinja::LogDebug("workflow_objc: Reusing analysis tables shared with another view");
+
+        // Keep the selector index in this view's database too, so it
+        // doesn't depend on the other view being open next time.
+        if (data->QueryMetadata("Objective-C") && !data->QueryMetadata(MetadataKey::SelectorIndex))
+            storeSelectorIndexes(data, key, *tables);
+
+        info->tables = std::move(tables);
         return info;
     }
-    for (const auto& selAndImps : metaKVS["selRefImplementations"]->GetArray())
-        info->selRefToImp[selAndImps->GetArray()[0]->GetUnsignedInteger()] = selAndImps->GetArray()[1]->GetUnsignedIntegerList();
-    for (const auto& selAndImps : metaKVS["selImplementations"]->GetArray())
-        info->selToImp[selAndImps->GetArray()[0]->GetUnsignedInteger()] = selAndImps->GetArray()[1]->GetUnsignedIntegerList();
 
-    g_viewInfos[id(data)] = info;
+    info->tables = g_sharedTables.insert(key, buildAnalysisTables(data, sections, key, imageBase));
     return info;
 }
 
+SharedAnalysisInfo GlobalState::analysisInfo(BinaryViewRef data)
+{
+    auto* slot = &viewState(data, id(data)).analysisInfo;
+
+    const auto imageBase = data->GetStart();
+    if (auto info = slot->current(); info && info->imageBase == imageBase)
+        return info;
+
+    // The info is built by the first thread to miss, while other threads
+    // wait on this view's slot alone.
+    std::unique_lock<std::mutex> lock(slot->lock);
+    while (true) {
+        const auto info = slot->current();
+        if (info && info->imageBase == imageBase)
+            return info;
+
+        // The tables are image-relative, so a rebased view only needs the
+        // base swapped out.
+        if (info) {
+            auto rebased = std::make_shared<AnalysisInfo>(*info);
+            rebased->imageBase = imageBase;
+            BinaryNinja::LogDebug("workflow_objc: Rebased analysis info from 0x%llx to 0x%llx",
+                static_cast<unsigned long long>(info->imageBase), static_cast<unsigned long long>(imageBase));
+            slot->publish(rebased);
+            return rebased;
+        }
+        if (!slot->isBuilding)
+            break;
+
+        auto start = Performance::now();
+        slot->ready.wait(lock);
+        g_analysisInfoBlockedTime.fetch_add(
+            Performance::elapsed<std::chrono::nanoseconds>(start).count(), std::memory_order_relaxed);
+    }
+
+    slot->isBuilding = true;
+    lock.unlock();
+
+    SharedAnalysisInfo info;
+    auto buildStart = Performance::now();
+    try {
+        info = buildAnalysisInfo(data);
+    } catch (...) {
+        lock.lock();
+        slot->isBuilding = false;
+        slot->ready.notify_all();
+        throw;
+    }
+
+    BinaryNinja::LogDebug("workflow_objc: Built analysis info in %lld ms (threads blocked %lld ms in total)",
+        static_cast<long long>(Performance::elapsed<std::chrono::milliseconds>(buildStart).count()),
+        static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(analysisInfoBlockedTime()).count()));
+
+    lock.lock();
+    slot->publish(info);
+    slot->isBuilding = false;
+    slot->ready.notify_all();
+    return info;
+}
+
+/**
+ * Number of selectors each method call preparation worker takes at a time.
+ */
+constexpr size_t PreparationBatchSize = 1024;
+
+/**
+ * A method call preparation in progress, shared by the workers running it.
+ */
+struct MethodCallPreparation {
+    BinaryViewRef data;
+    ViewState* state;
+    SharedAnalysisInfo info;
+    high_res_clock::time_point start;
+
+    std::vector<uint64_t> selectors;
+    std::atomic<size_t> nextBatch = 0;
+    std::atomic<size_t> remainingWorkers = 0;
+    std::atomic<bool> failed = false;
+
+    /**
+     * Claim batches of selectors until none are left, reading each one into
+     * the selector table and building its `objc_msgSend` call type. The last
+     * worker to finish marks the preparation as done.
+     */
+    void work()
+    {
+        try {
+            for (size_t begin; !failed && (begin = nextBatch.fetch_add(PreparationBatchSize)) < selectors.size();) {
+                for (size_t i = begin, end = std::min(begin + PreparationBatchSize, selectors.size()); i < end; ++i) {
+                    const auto address = selectors[i];
+                    const auto selector = state->selectorTable.selectorAt(data, address, info.get());
+                    if (selector->valid)
+                        state->callTypeCache.callType(
+                            data, *selector, CallTargetKind::MessageSend, info->methodEncoding(address));
+                }
+            }
+        } catch (std::exception& e) {
+            if (!failed.exchange(true))
+                BinaryNinja::LogRegistry::GetLogger(PluginLoggerName)->LogError(
+                    "Failed to prepare method calls: %s", e.what());
+        }
+
+        if (remainingWorkers.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+
+        {
+            std::unique_lock<std::mutex> lock(state->methodCallPreparationLock);
+            state->isPreparingMethodCalls = false;
+        }
+
+        BinaryNinja::LogDebug("workflow_objc: Prepared method calls for %zu selectors in %lld ms", selectors.size(),
+            static_cast<long long>(Performance::elapsed<std::chrono::milliseconds>(start).count()));
+    }
+};
+
+void GlobalState::prepareMethodCalls(BinaryViewRef data)
+{
+    auto& state = viewState(data, id(data));
+    const auto info = analysisInfo(data);
+    if (!info)
+        return;
+
+    // The generation is recorded before the caches are filled, so call types
+    // invalidated while this runs are prepared again afterwards.
+    {
+        std::unique_lock<std::mutex> lock(state.methodCallPreparationLock);
+        const auto generation = state.callTypeCache.generation();
+        if (state.isPreparingMethodCalls
+            || (state.hasPreparedMethodCalls.load(std::memory_order_relaxed)
+                && state.preparedImageBase.load(std::memory_order_relaxed) == info->imageBase
+                && state.preparedCallTypeGeneration.load(std::memory_order_relaxed) == generation))
+            return;
+
+        state.isPreparingMethodCalls = true;
+        state.preparedImageBase.store(info->imageBase, std::memory_order_relaxed);
+        state.preparedCallTypeGeneration.store(generation, std::memory_order_relaxed);
+        state.hasPreparedMethodCalls.store(true, std::memory_order_release);
+    }
+
+    // Call sites pass either a selector reference or the name it points to,
+    // and the selector table is keyed by the address passed, so both are
+    // prepared. The call type cache is keyed by what is read from them, so
+    // each type is only built once.
+    //
+    // The preparation holds a reference to the view, which keeps the file,
+    // and so the view state, alive until the last worker is done with it.
+    const auto& strings = info->tables->selectorStrings;
+    auto preparation = std::make_shared<MethodCallPreparation>();
+    preparation->data = data;
+    preparation->state = &state;
+    preparation->info = info;
+    preparation->start = Performance::now();
+    preparation->selectors = strings.referencedNames();
+    preparation->selectors.insert(
+        preparation->selectors.end(), strings.references().begin(), strings.references().end());
+    for (auto& selector : preparation->selectors)
+        selector += info->imageBase;
+
+    const auto batchCount = (preparation->selectors.size() + PreparationBatchSize - 1) / PreparationBatchSize;
+    const auto workerCount = std::max<size_t>(1, std::min(BinaryNinja::GetWorkerThreadCount(), batchCount));
+    preparation->remainingWorkers = workerCount;
+    for (size_t i = 0; i < workerCount; ++i)
+        BinaryNinja::WorkerEnqueue([preparation]() { preparation->work(); }, "Objective-C method call preparation");
+}
+
+std::chrono::nanoseconds GlobalState::analysisInfoBlockedTime()
+{
+    return std::chrono::nanoseconds(g_analysisInfoBlockedTime.load(std::memory_order_relaxed));
+}
+
 bool GlobalState::hasAnalysisInfo(BinaryViewRef data)
 {
     return data->QueryMetadata("Objective-C") != nullptr;
@@ -100,3 +1117,82 @@ void GlobalState::setFlag(BinaryViewRef bv, const std::string& flag)
 {
     bv->StoreMetadata(flag, new BinaryNinja::Metadata("YES"));
 }
+
+/**
+ * Releases a view's state once its file is closed.
+ *
+ * State is keyed by session ID, which is shared by every view of a file, so
+ * the file's destruction (after all of its views are gone) is the point at
+ * which nothing can ask for the state again. The caches' notifications and
+ * any pending performance report are removed earlier, as the view they belong
+ * to is destroyed.
+ */
+class ViewStateDestructor : public BinaryNinja::ObjectDestructor {
+public:
+    void DestructBinaryView(BinaryNinja::BinaryView* view) override
+    {
+        if (auto state = g_viewStates.find(view->GetFile()->GetSessionId())) {
+            cancelAnalysisReport(*state, view);
+            unregisterNotifications(*state, view);
+        }
+    }
+
+    void DestructFileMetadata(BinaryNinja::FileMetadata* file) override
+    {
+        const auto id = file->GetSessionId();
+        if (auto state = g_viewStates.find(id))
+            unregisterNotifications(*state);
+        g_viewStates.erase(id);
+    }
+};
+
+void GlobalState::registerCleanupHandlers()
+{
+    // Intentionally leaked; destruction callbacks must outlive every view.
+    static auto* destructor = new ViewStateDestructor();
+    (void)destructor;
+}
+
+void GlobalState::logLiveViews()
+{
+    const auto log = BinaryNinja::LogRegistry::GetLogger(PluginLoggerName);
+
+    // Tables shared between views are only counted once in the total, and
+    // separately for what they would take if every view had its own copy.
+    size_t totalBytes = 0;
+    size_t unsharedTableBytes = 0;
+    std::set<const AnalysisTables*> countedTables;
+    g_viewStates.forEach([&](BinaryViewID id, ViewState& state) {
+        size_t messageHandlerBytes = 0;
+        if (state.hasMessageHandler.load(std::memory_order_acquire))
+            messageHandlerBytes = state.messageHandler->memoryUsage();
+        size_t selectorTableBytes = state.selectorTable.memoryUsage();
+        size_t callTypeBytes = state.callTypeCache.memoryUsage();
+        size_t pointerTokenBytes = state.pointerTokenCache.memoryUsage();
+        size_t functionMemoBytes = state.functionMemo.memoryUsage();
+        size_t analysisInfoBytes = 0;
+        bool isShared = false;
+        if (const auto info = state.analysisInfo.current()) {
+            analysisInfoBytes = info->memoryUsage();
+            unsharedTableBytes += info->tables->memoryUsage();
+            isShared = !countedTables.insert(info->tables.get()).second;
+        }
+
+        size_t bytes = sizeof(ViewState) + messageHandlerBytes + selectorTableBytes + callTypeBytes + analysisInfoBytes
+            + pointerTokenBytes + functionMemoBytes;
+        totalBytes += isShared ? bytes - analysisInfoBytes + sizeof(AnalysisInfo) : bytes;
+
+        log->LogInfo("Session %zu: %zu bytes (analysis info %zu%s, selectors %zu, call types %zu, "
+                     "pointer tokens %zu, function memo %zu, message handler %zu)%s",
+            id, bytes, analysisInfoBytes, isShared ? " shared" : "", selectorTableBytes, callTypeBytes,
+            pointerTokenBytes, functionMemoBytes, messageHandlerBytes, state.isIgnored.load(std::memory_order_relaxed) ? ", ignored" : "");
+    });
+
+    size_t sharedTableBytes = 0;
+    for (const auto* tables : countedTables)
+        sharedTableBytes += tables->memoryUsage();
+
+    log->LogInfo("%zu view(s) with live Objective-C plugin state, %zu bytes in total", g_viewStates.size(), totalBytes);
+    log->LogInfo("Analysis tables: %zu distinct set(s) for %zu view(s), %zu bytes (%zu bytes without sharing)",
+        countedTables.size(), g_viewStates.size(), sharedTableBytes, unsharedTableBytes);
+}
@@ -7,10 +7,18 @@
 
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
 #include "BinaryNinja.h"
 
+#include "AnalysisInfo.h"
+#include "CallTypeCache.h"
+#include "Capture.h"
+#include "FunctionMemo.h"
 #include "MessageHandler.h"
+#include "PointerTokenCache.h"
+#include "Performance.h"
+#include "SelectorTable.h"
 
 /**
  * Namespace to hold metadata flag key constants.
@@ -22,15 +30,15 @@ constexpr auto DidRunStructureAnalysis = "objectiveNinja.didRunStructureAnalysis
 
 }
 
-struct AnalysisInfo {
-    std::uint64_t imageBase;
-    bool hasObjcStubs = false;
-    std::pair<uint64_t, uint64_t> objcStubsStartEnd;
-    std::unordered_map<uint64_t, std::vector<uint64_t>> selRefToImp;
-    std::unordered_map<uint64_t, std::vector<uint64_t>> selToImp;
-};
+/**
+ * Namespace to hold other metadata key constants.
+ */
+namespace MetadataKey {
 
-typedef std::shared_ptr<AnalysisInfo> SharedAnalysisInfo;
+constexpr auto PerformanceCounters = "objectiveNinja.performanceCounters";
+constexpr auto SelectorIndex = "objectiveNinja.selectorIndex";
+
+}
 
 /**
  * Global state/storage interface.
@@ -47,11 +55,65 @@ public:
      */
     static SharedAnalysisInfo analysisInfo(BinaryViewRef);
 
+    /**
+     * Get the total time threads have spent waiting for another thread to
+     * finish building a view's analysis info.
+     */
+    static std::chrono::nanoseconds analysisInfoBlockedTime();
+
     /**
      * Get ObjC Message Handler for a view
      */
     static MessageHandler* messageHandler(BinaryViewRef);
 
+    /**
+     * Fill a view's selector table and call type cache for every selector
+     * reference and selector name it has, spread across the analysis worker
+     * threads. Does nothing if they were already prepared for the view's
+     * image base and the current call types, or are being prepared.
+     */
+    static void prepareMethodCalls(BinaryViewRef);
+
+    /**
+     * Prepare a view's method calls again if they were prepared before, but
+     * for another image base or call types that have since been invalidated.
+     */
+    static void refreshMethodCalls(BinaryViewRef, const AnalysisInfo& info);
+
+    /**
+     * Get the address of every `objc_msgSend$selector` stub in a view's
+     * `__objc_stubs` sections whose selector load can't be decoded, by
+     * scanning those sections alone, without building the analysis info.
+     */
+    static std::vector<uint64_t> undecodedSelectorStubs(BinaryViewRef);
+
+    /**
+     * Get the selector table for a view.
+     */
+    static SelectorTable* selectorTable(BinaryViewRef);
+
+    /**
+     * Get the message send call type cache for a view.
+     */
+    static CallTypeCache* callTypeCache(BinaryViewRef);
+
+    /**
+     * Get the cache of rendered pointer tokens for a view.
+     */
+    static PointerTokenCache* pointerTokenCache(BinaryViewRef);
+
+    /**
+     * Get the memo of the rewrites made to each of a view's functions.
+     */
+    static FunctionMemo* functionMemo(BinaryViewRef);
+
+    /**
+     * Get the writer for the capture file named by the `WORKFLOW_OBJC_CAPTURE`
+     * environment variable, or null if capturing is disabled. The view's
+     * tables are written to the file the first time this is called for it.
+     */
+    static Capture::Writer* captureWriter(BinaryViewRef);
+
     /**
      * Check if analysis info exists for a view.
      */
@@ -67,6 +129,23 @@ public:
      */
     static bool viewIsIgnored(BinaryViewRef);
 
+    /**
+     * Get the performance counters for a view.
+     */
+    static PerformanceCounters& performanceCounters(BinaryViewRef);
+
+    /**
+     * Log a summary of a view's performance counters and store them in the
+     * view's metadata.
+     */
+    static void reportPerformance(BinaryViewRef);
+
+    /**
+     * Arrange for `reportPerformance` to run when the view's current analysis
+     * completes, unless that is already arranged.
+     */
+    static void scheduleAnalysisReport(BinaryViewRef);
+
     /**
      * Check if the a metadata flag is present for a view.
      */
@@ -76,4 +155,14 @@ public:
      * Set a metadata flag for a view.
      */
     static void setFlag(BinaryViewRef, const std::string&);
+
+    /**
+     * Register handlers that release a view's state when its file is closed.
+     */
+    static void registerCleanupHandlers();
+
+    /**
+     * Log every view with live plugin state and its approximate size.
+     */
+    static void logLiveViews();
 };
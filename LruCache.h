@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * Fixed-capacity map that evicts its least recently used entry when full.
+ *
+ * Entries live in a list ordered by recency, indexed by a hash map, so both
+ * lookups and insertions are constant time. Not thread-safe.
+ */
+template <typename Key, typename Value>
+class LruCache {
+    using Entry = std::pair<Key, Value>;
+
+    size_t m_capacity;
+    std::list<Entry> m_entries;
+    std::unordered_map<Key, typename std::list<Entry>::iterator> m_index;
+
+public:
+    explicit LruCache(size_t capacity)
+        : m_capacity(capacity ? capacity : 1)
+    {
+        m_index.reserve(m_capacity);
+    }
+
+    /**
+     * Get the value for a key, marking it as the most recently used, or null
+     * if the key is not cached. The pointer is valid until the next change.
+     */
+    const Value* find(const Key& key)
+    {
+        auto it = m_index.find(key);
+        if (it == m_index.end())
+            return nullptr;
+
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return &it->second->second;
+    }
+
+    /**
+     * Add or replace the value for a key, evicting the least recently used
+     * entry if the cache is full.
+     */
+    void insert(const Key& key, Value value)
+    {
+        if (auto it = m_index.find(key); it != m_index.end()) {
+            it->second->second = std::move(value);
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            return;
+        }
+
+        if (m_entries.size() == m_capacity) {
+            m_index.erase(m_entries.back().first);
+            m_entries.pop_back();
+        }
+
+        m_entries.emplace_front(key, std::move(value));
+        m_index.emplace(key, m_entries.begin());
+    }
+
+    /**
+     * Call `visitor(key, value)` for every entry, most recently used first,
+     * without changing their order.
+     */
+    template <typename Visitor>
+    void forEach(Visitor&& visitor) const
+    {
+        for (const auto& [key, value] : m_entries)
+            visitor(key, value);
+    }
+
+    void clear()
+    {
+        m_entries.clear();
+        m_index.clear();
+    }
+
+    size_t size() const { return m_entries.size(); }
+    size_t capacity() const { return m_capacity; }
+};
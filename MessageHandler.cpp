@@ -3,13 +3,13 @@
 using namespace BinaryNinja;
 
 MessageHandler::MessageHandler(Ref<BinaryView> data)
+    : m_callTargets(findCallTargets(data))
 {
-    m_msgSendFunctions = findMsgSendFunctions(data);
 }
 
-std::set<uint64_t> MessageHandler::findMsgSendFunctions(BinaryNinja::Ref<BinaryNinja::BinaryView> data)
+CallTargetTable MessageHandler::findCallTargets(BinaryNinja::Ref<BinaryNinja::BinaryView> data)
 {
-    std::set<uint64_t> results;
+    std::vector<std::pair<uint64_t, CallTargetKind>> results;
 
     const auto authStubsSection = data->GetSectionByName("__auth_stubs");
     const auto stubsSection = data->GetSectionByName("__stubs");
@@ -43,21 +43,48 @@ std::set<uint64_t> MessageHandler::findMsgSendFunctions(BinaryNinja::Ref<BinaryN
     // routed through the stub function, making it important to make note of
     // both symbols' addresses. Furthermore, on ARM64, the `__auth{stubs,got}`
     // sections are preferred over their unauthenticated counterparts.
-    const auto candidates = data->GetSymbolsByName("_objc_msgSend");
-    for (const auto& c : candidates) {
-        if ((authStubsSection && sectionContains(authStubsSection, c))
-            || (stubsSection && sectionContains(stubsSection, c))
-            || (authGotSection && sectionContains(authGotSection, c))
-            || (gotSection && sectionContains(gotSection, c))
-            || (laSymbolPtrSection && sectionContains(laSymbolPtrSection, c))) {
-            results.insert(c->GetAddress());
+    //
+    // The same applies to the rest of the `objc_msgSend` family, and to the
+    // runtime functions that tell the class of the object they return.
+    const std::pair<const char*, CallTargetKind> functions[] = {
+        { "_objc_msgSend", CallTargetKind::MessageSend },
+        { "_objc_msgSend_fpret", CallTargetKind::MessageSend },
+        { "_objc_msgSend_fp2ret", CallTargetKind::MessageSend },
+        { "_objc_msgSend_stret", CallTargetKind::MessageSendStret },
+        { "_objc_msgSendSuper", CallTargetKind::MessageSendSuper },
+        { "_objc_msgSendSuper2", CallTargetKind::MessageSendSuper },
+        { "_objc_msgSendSuper_stret", CallTargetKind::MessageSendSuperStret },
+        { "_objc_msgSendSuper2_stret", CallTargetKind::MessageSendSuperStret },
+        { "_objc_alloc", CallTargetKind::Allocate },
+        { "_objc_opt_class", CallTargetKind::ClassOf },
+    };
+    for (const auto& [name, kind] : functions) {
+        const auto candidates = data->GetSymbolsByName(name);
+        for (const auto& c : candidates) {
+            if ((authStubsSection && sectionContains(authStubsSection, c))
+                || (stubsSection && sectionContains(stubsSection, c))
+                || (authGotSection && sectionContains(authGotSection, c))
+                || (gotSection && sectionContains(gotSection, c))
+                || (laSymbolPtrSection && sectionContains(laSymbolPtrSection, c))) {
+                results.emplace_back(c->GetAddress(), kind);
+            }
         }
     }
 
-    return results;
-}
+    // Calls were previously also matched on the raw name of the symbol at the
+    // call target, wherever it was, so keep accepting `_objc_msgSend` symbols
+    // outside of the sections above as a fallback.
+    for (const auto& c : data->GetSymbolsByName("_objc_msgSend"))
+        results.emplace_back(c->GetAddress(), CallTargetKind::MessageSend);
 
-bool MessageHandler::isMessageSend(uint64_t functionAddress)
-{
-    return m_msgSendFunctions.count(functionAddress);
+    // Selector stubs (`_objc_msgSend$selector`) load the selector themselves,
+    // and live in their own section.
+    if (const auto objcStubsSection = data->GetSectionByName("__objc_stubs")) {
+        for (const auto& symbol : data->GetSymbols(objcStubsSection->GetStart(), objcStubsSection->GetLength())) {
+            if (symbol->GetRawName().rfind("_objc_msgSend$", 0) == 0)
+                results.emplace_back(symbol->GetAddress(), CallTargetKind::SelectorStub);
+        }
+    }
+
+    return CallTargetTable(results);
 }
@@ -2,15 +2,26 @@
 
 #include <binaryninjaapi.h>
 
+#include "CallTargetTable.h"
+
 class MessageHandler {
 
-    std::set<uint64_t> m_msgSendFunctions;
-    static std::set<uint64_t> findMsgSendFunctions(BinaryNinja::Ref<BinaryNinja::BinaryView> data);
+    CallTargetTable m_callTargets;
+    static CallTargetTable findCallTargets(BinaryNinja::Ref<BinaryNinja::BinaryView> data);
 
 public:
     MessageHandler(BinaryNinja::Ref<BinaryNinja::BinaryView> data);
 
-    std::set<uint64_t> getMessageSendFunctions() const { return m_msgSendFunctions; }
-    bool hasMessageSendFunctions() const { return m_msgSendFunctions.size() != 0; }
-    bool isMessageSend(uint64_t);
+    const CallTargetTable& getCallTargets() const { return m_callTargets; }
+    bool hasMessageSendFunctions() const { return !m_callTargets.empty(); }
+
+    /**
+     * Get the kind of the call target at the given address.
+     */
+    CallTargetKind classify(uint64_t address) const { return m_callTargets.classify(address); }
+
+    /**
+     * Get the approximate number of heap bytes used by the handler.
+     */
+    size_t memoryUsage() const { return m_callTargets.memoryUsage(); }
 };
@@ -0,0 +1,110 @@
+#include "MethodTypeIndex.h"
+
+#include "Serialization.h"
+
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+using namespace Serialization;
+
+void MethodTypeIndex::Builder::addTypes(uint64_t start, const uint8_t* bytes, size_t size)
+{
+    m_strings.addNames(start, bytes, size);
+}
+
+void MethodTypeIndex::Builder::addMethod(uint64_t name, uint64_t types)
+{
+    m_methods.emplace_back(name, types);
+}
+
+MethodTypeIndex MethodTypeIndex::Builder::build(const SelectorStrings& names)
+{
+    const auto strings = m_strings.build();
+    auto textAt = [&](uint64_t address) {
+        if (auto text = strings.text(address))
+            return text;
+        return names.text(address);
+    };
+
+    // Methods with the same name usually point at the same string, so runs
+    // of one name are checked by address before comparing text.
+    std::sort(m_methods.begin(), m_methods.end());
+
+    MethodTypeIndex result;
+    std::unordered_map<std::string_view, uint32_t> offsets;
+    for (auto it = m_methods.begin(); it != m_methods.end();) {
+        const auto name = it->first;
+        auto encoding = textAt(it->second);
+        auto last = it->second;
+        for (++it; it != m_methods.end() && it->first == name; ++it) {
+            if (it->second == last)
+                continue;
+            last = it->second;
+            if (textAt(it->second) != encoding)
+                encoding = std::nullopt;
+        }
+        if (!encoding || encoding->empty())
+            continue;
+
+        auto [offset, isNew] = offsets.try_emplace(*encoding, static_cast<uint32_t>(result.m_text.size()));
+        if (isNew) {
+            result.m_text.insert(result.m_text.end(), encoding->begin(), encoding->end());
+            result.m_text.push_back('\0');
+        }
+
+        result.m_names.push_back(name);
+        result.m_offsets.push_back(offset->second);
+    }
+
+    m_methods.clear();
+    return result;
+}
+
+std::optional<std::string_view> MethodTypeIndex::find(uint64_t name) const
+{
+    if (m_names.empty() || name < m_names.front() || name > m_names.back())
+        return std::nullopt;
+
+    auto it = std::lower_bound(m_names.begin(), m_names.end(), name);
+    if (it == m_names.end() || *it != name)
+        return std::nullopt;
+
+    return std::string_view(m_text.data() + m_offsets[it - m_names.begin()]);
+}
+
+void MethodTypeIndex::serialize(std::vector<uint8_t>& out) const
+{
+    writeValue(out, m_names.size());
+    writeValue(out, m_text.size());
+    writeArray(out, m_names.data(), m_names.size());
+    writeArray(out, m_offsets.data(), m_offsets.size());
+    writeArray(out, m_text.data(), m_text.size());
+}
+
+std::optional<MethodTypeIndex> MethodTypeIndex::deserialize(const uint8_t*& data, const uint8_t* end)
+{
+    uint64_t nameCount, textSize;
+    if (!readValue(data, end, nameCount) || !readValue(data, end, textSize))
+        return std::nullopt;
+
+    MethodTypeIndex index;
+    if (!readArray(data, end, index.m_names, nameCount) || !readArray(data, end, index.m_offsets, nameCount)
+        || !readArray(data, end, index.m_text, textSize)) {
+        return std::nullopt;
+    }
+
+    // Encodings are read as NUL-terminated strings from their offsets, so
+    // every offset must land inside the text and the text must end in a NUL.
+    if (std::adjacent_find(index.m_names.begin(), index.m_names.end(), std::greater_equal<uint64_t>())
+        != index.m_names.end())
+        return std::nullopt;
+    if (!index.m_names.empty() && (index.m_text.empty() || index.m_text.back() != '\0'))
+        return std::nullopt;
+    for (const auto offset : index.m_offsets) {
+        if (offset >= index.m_text.size())
+            return std::nullopt;
+    }
+
+    return index;
+}
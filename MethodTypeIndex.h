@@ -0,0 +1,83 @@
+#pragma once
+
+#include "SelectorStrings.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Immutable map from a selector name address to the type encoding of the
+ * methods in the image implementing it.
+ *
+ * A selector is only mapped if every method implementing it has the same
+ * encoding, so a message send's types can be taken from it without knowing
+ * the class of the receiver. Each distinct encoding is stored once.
+ */
+class MethodTypeIndex {
+    std::vector<uint64_t> m_names;
+
+    /**
+     * Position of each name's encoding in the text buffer, which holds every
+     * distinct encoding followed by a NUL.
+     */
+    std::vector<uint32_t> m_offsets;
+    std::vector<char> m_text;
+
+public:
+    class Builder {
+        SelectorStrings::Builder m_strings;
+        std::vector<std::pair<uint64_t, uint64_t>> m_methods;
+
+    public:
+        /**
+         * Add the contents of a method type section starting at `start`.
+         */
+        void addTypes(uint64_t start, const uint8_t* bytes, size_t size);
+
+        /**
+         * Add a method with the selector name at `name` and the type encoding
+         * string at `types`.
+         */
+        void addMethod(uint64_t name, uint64_t types);
+
+        /**
+         * Resolve the encoding of every method added and pack them into an
+         * index.
+         *
+         * @param names The view's selector names, where some linkers put
+         * method types too; used for types outside the added sections
+         */
+        MethodTypeIndex build(const SelectorStrings& names);
+    };
+
+    MethodTypeIndex() = default;
+
+    /**
+     * Get the type encoding shared by the methods implementing the selector
+     * name at the given address, if there is one.
+     */
+    std::optional<std::string_view> find(uint64_t name) const;
+
+    /**
+     * Append the index to a buffer in a compact binary form that can be
+     * loaded back with `deserialize`. The encoding uses the host's byte order.
+     */
+    void serialize(std::vector<uint8_t>& out) const;
+
+    /**
+     * Load an index written by `serialize`, advancing `data` past it.
+     * Returns nothing if the data is truncated or inconsistent.
+     */
+    static std::optional<MethodTypeIndex> deserialize(const uint8_t*& data, const uint8_t* end);
+
+    size_t size() const { return m_names.size(); }
+    bool empty() const { return m_names.empty(); }
+    size_t memoryUsage() const
+    {
+        return m_names.capacity() * sizeof(uint64_t) + m_offsets.capacity() * sizeof(uint32_t) + m_text.capacity();
+    }
+};
@@ -0,0 +1,98 @@
+#include "ObjCStubs.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+/**
+ * Register the selector is passed in.
+ */
+constexpr uint32_t SelectorRegister = 1;
+
+uint32_t readInstruction(const uint8_t* code)
+{
+    uint32_t instruction;
+    std::memcpy(&instruction, code, sizeof(instruction));
+    return instruction;
+}
+
+/**
+ * Decode `ADRP x1, page`, returning the page address.
+ */
+std::optional<uint64_t> decodeAdrp(uint64_t address, uint32_t instruction)
+{
+    if ((instruction & 0x9f000000) != 0x90000000 || (instruction & 0x1f) != SelectorRegister)
+        return std::nullopt;
+
+    const uint64_t immlo = (instruction >> 29) & 0x3;
+    const uint64_t immhi = (instruction >> 5) & 0x7ffff;
+    auto pages = static_cast<int64_t>((immhi << 2) | immlo);
+    if (pages & (1 << 20))
+        pages -= 1 << 21;
+
+    return (address & ~uint64_t(0xfff)) + static_cast<uint64_t>(pages * 0x1000);
+}
+
+/**
+ * Decode `LDR x1, [x1, #offset]`, returning the offset.
+ */
+std::optional<uint64_t> decodeLdr(uint32_t instruction)
+{
+    if ((instruction & 0xffc00000) != 0xf9400000 || (instruction & 0x1f) != SelectorRegister
+        || ((instruction >> 5) & 0x1f) != SelectorRegister)
+        return std::nullopt;
+
+    return ((instruction >> 10) & 0xfff) * 8;
+}
+
+} // unnamed namespace
+
+std::vector<std::pair<uint64_t, uint64_t>> decodeArm64SelectorStubs(uint64_t address, const uint8_t* code, size_t length)
+{
+    std::vector<std::pair<uint64_t, uint64_t>> stubs;
+
+    // Stubs are 12 or 32 bytes depending on the linker mode, so rather than
+    // assume a stride, look for the selector load at every instruction.
+    for (size_t offset = 0; offset + 8 <= length; offset += 4) {
+        const auto page = decodeAdrp(address + offset, readInstruction(code + offset));
+        if (!page)
+            continue;
+        const auto pageOffset = decodeLdr(readInstruction(code + offset + 4));
+        if (!pageOffset)
+            continue;
+
+        stubs.emplace_back(address + offset, *page + *pageOffset);
+        offset += 4;
+    }
+
+    return stubs;
+}
+
+SelectorStubIndex::SelectorStubIndex(std::vector<std::pair<uint64_t, uint64_t>> entries)
+{
+    std::stable_sort(entries.begin(), entries.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                      [](const auto& a, const auto& b) { return a.first == b.first; }),
+        entries.end());
+
+    m_stubs.reserve(entries.size());
+    m_selectors.reserve(entries.size());
+    for (const auto& [stub, selector] : entries) {
+        m_stubs.push_back(stub);
+        m_selectors.push_back(selector);
+    }
+}
+
+std::optional<uint64_t> SelectorStubIndex::find(uint64_t stub) const
+{
+    if (m_stubs.empty() || stub < m_stubs.front() || stub > m_stubs.back())
+        return std::nullopt;
+
+    auto it = std::lower_bound(m_stubs.begin(), m_stubs.end(), stub);
+    if (it == m_stubs.end() || *it != stub)
+        return std::nullopt;
+
+    return m_selectors[it - m_stubs.begin()];
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * Find the selector reference loaded by each `objc_msgSend$selector` stub in
+ * a block of ARM64 code from an `__objc_stubs` section.
+ *
+ * Every stub starts by loading its selector into x1 with an ADRP/LDR pair,
+ * followed by a branch to `objc_msgSend`; the rest of the stub varies by
+ * linker mode and architecture variant, so only that pair is decoded. The
+ * result is a list of (stub address, selector reference address) pairs.
+ *
+ * @param address The address of the first byte of `code`
+ */
+std::vector<std::pair<uint64_t, uint64_t>> decodeArm64SelectorStubs(uint64_t address, const uint8_t* code, size_t length);
+
+/**
+ * Immutable map from the address of each decoded selector stub to the
+ * address of the selector name it passes to `objc_msgSend`.
+ */
+class SelectorStubIndex {
+    std::vector<uint64_t> m_stubs;
+    std::vector<uint64_t> m_selectors;
+
+public:
+    SelectorStubIndex() = default;
+
+    /**
+     * Build an index from (stub address, selector address) pairs. The first
+     * selector given for a stub wins.
+     */
+    explicit SelectorStubIndex(std::vector<std::pair<uint64_t, uint64_t>> entries);
+
+    /**
+     * Get the selector address passed by the stub at the given address, if it
+     * is a decoded stub.
+     */
+    std::optional<uint64_t> find(uint64_t stub) const;
+
+    /**
+     * Call `visitor(stub, selector)` for every entry in the index.
+     */
+    template <typename Visitor>
+    void forEach(Visitor&& visitor) const
+    {
+        for (size_t i = 0; i < m_stubs.size(); ++i)
+            visitor(m_stubs[i], m_selectors[i]);
+    }
+
+    size_t size() const { return m_stubs.size(); }
+    bool empty() const { return m_stubs.empty(); }
+    size_t memoryUsage() const { return (m_stubs.capacity() + m_selectors.capacity()) * sizeof(uint64_t); }
+};
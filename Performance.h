@@ -7,7 +7,11 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <string>
 
 using high_res_clock = std::chrono::high_resolution_clock;
 
@@ -36,3 +40,181 @@ public:
         return std::chrono::duration_cast<T>(end - start);
     }
 };
+
+/**
+ * Event counters kept by the workflow.
+ */
+enum class Counter {
+    FunctionsVisited,
+    FunctionsSkipped,
+    InstructionsScanned,
+    MessageSendCandidates,
+    CFStringCandidates,
+    RewritesApplied,
+    SSARegenerations,
+    ReceiverResolvedCalls,
+    FunctionsMemoized,
+    Count,
+};
+
+/**
+ * Timed phases of the workflow.
+ */
+enum class Phase {
+    Classification,
+    SelectorRead,
+    TypeBuilding,
+    ILReplacement,
+    SSAGeneration,
+    Count,
+};
+
+constexpr size_t CounterCount = static_cast<size_t>(Counter::Count);
+constexpr size_t PhaseCount = static_cast<size_t>(Phase::Count);
+
+/**
+ * Counters and phase timings accumulated by one thread while it analyzes a
+ * single function. Plain integers; only ever touched by the owning thread.
+ */
+struct PerformanceSample {
+    std::array<uint64_t, CounterCount> counters {};
+    std::array<uint64_t, PhaseCount> phaseTotal {};
+    std::array<uint64_t, PhaseCount> phaseMax {};
+
+    void count(Counter counter, uint64_t n = 1) { counters[static_cast<size_t>(counter)] += n; }
+
+    void addTime(Phase phase, uint64_t nanoseconds)
+    {
+        auto i = static_cast<size_t>(phase);
+        phaseTotal[i] += nanoseconds;
+        if (nanoseconds > phaseMax[i])
+            phaseMax[i] = nanoseconds;
+    }
+
+    /**
+     * Get the sample for the current thread.
+     */
+    static PerformanceSample& current()
+    {
+        static thread_local PerformanceSample sample;
+        return sample;
+    }
+};
+
+/**
+ * Times a phase for as long as it is in scope, adding the result to the
+ * current thread's sample.
+ */
+class PhaseTimer {
+    Phase m_phase;
+    high_res_clock::time_point m_start;
+
+public:
+    explicit PhaseTimer(Phase phase)
+        : m_phase(phase)
+        , m_start(Performance::now())
+    {
+    }
+
+    ~PhaseTimer()
+    {
+        PerformanceSample::current().addTime(m_phase,
+            Performance::elapsed<std::chrono::nanoseconds>(m_start).count());
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+};
+
+/**
+ * Per-view totals of the workflow's counters and phase timings.
+ *
+ * Threads accumulate into their own `PerformanceSample` while analyzing a
+ * function and merge it here once when done, so the shared atomics are only
+ * touched once per function.
+ */
+class PerformanceCounters {
+    std::array<std::atomic<uint64_t>, CounterCount> m_counters {};
+    std::array<std::atomic<uint64_t>, PhaseCount> m_phaseTotal {};
+    std::array<std::atomic<uint64_t>, PhaseCount> m_phaseMax {};
+
+public:
+    /**
+     * Add a sample to the totals.
+     */
+    void merge(const PerformanceSample& sample)
+    {
+        for (size_t i = 0; i < CounterCount; ++i)
+            if (sample.counters[i])
+                m_counters[i].fetch_add(sample.counters[i], std::memory_order_relaxed);
+
+        for (size_t i = 0; i < PhaseCount; ++i) {
+            if (!sample.phaseTotal[i])
+                continue;
+
+            m_phaseTotal[i].fetch_add(sample.phaseTotal[i], std::memory_order_relaxed);
+
+            auto max = m_phaseMax[i].load(std::memory_order_relaxed);
+            while (sample.phaseMax[i] > max
+                && !m_phaseMax[i].compare_exchange_weak(max, sample.phaseMax[i], std::memory_order_relaxed)) { }
+        }
+    }
+
+    /**
+     * Copy the current totals.
+     */
+    PerformanceSample snapshot() const
+    {
+        PerformanceSample sample;
+        for (size_t i = 0; i < CounterCount; ++i)
+            sample.counters[i] = m_counters[i].load(std::memory_order_relaxed);
+        for (size_t i = 0; i < PhaseCount; ++i) {
+            sample.phaseTotal[i] = m_phaseTotal[i].load(std::memory_order_relaxed);
+            sample.phaseMax[i] = m_phaseMax[i].load(std::memory_order_relaxed);
+        }
+
+        return sample;
+    }
+
+    uint64_t get(Counter counter) const { return m_counters[static_cast<size_t>(counter)].load(std::memory_order_relaxed); }
+
+    static const char* name(Counter counter)
+    {
+        static constexpr const char* names[] = { "functionsVisited", "functionsSkipped", "instructionsScanned",
+            "messageSendCandidates", "cfStringCandidates", "rewritesApplied", "ssaRegenerations",
+            "receiverResolvedCalls", "functionsMemoized" };
+        static_assert(sizeof(names) / sizeof(names[0]) == CounterCount);
+        return names[static_cast<size_t>(counter)];
+    }
+
+    static const char* name(Phase phase)
+    {
+        static constexpr const char* names[] = { "classification", "selectorRead", "typeBuilding",
+            "ilReplacement", "ssaGeneration" };
+        static_assert(sizeof(names) / sizeof(names[0]) == PhaseCount);
+        return names[static_cast<size_t>(phase)];
+    }
+
+    /**
+     * Format a sample as a single human-readable line.
+     */
+    static std::string format(const PerformanceSample& sample)
+    {
+        std::string result;
+        for (size_t i = 0; i < CounterCount; ++i) {
+            result += name(static_cast<Counter>(i));
+            result += '=';
+            result += std::to_string(sample.counters[i]);
+            result += ' ';
+        }
+        for (size_t i = 0; i < PhaseCount; ++i) {
+            result += name(static_cast<Phase>(i));
+            result += "=" + std::to_string(sample.phaseTotal[i] / 1000000) + "ms";
+            result += "(max " + std::to_string(sample.phaseMax[i] / 1000) + "us)";
+            if (i + 1 < PhaseCount)
+                result += ' ';
+        }
+
+        return result;
+    }
+};
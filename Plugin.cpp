@@ -7,6 +7,7 @@
 
 #include "Constants.h"
 #include "DataRenderers.h"
+#include "GlobalState.h"
 #include "Workflow.h"
 #include "ArchitectureHooks.h"
 
@@ -26,6 +27,7 @@ BINARYNINJAPLUGIN bool CorePluginInit()
 	RelativePointerDataRenderer::Register();
 
 	Workflow::registerActivities();
+	GlobalState::registerCleanupHandlers();
 
 	std::vector<BinaryNinja::Ref<BinaryNinja::Architecture>> targets = {
 		BinaryNinja::Architecture::GetByName("aarch64"),
@@ -50,6 +52,21 @@ BINARYNINJAPLUGIN bool CorePluginInit()
 		"aliases": ["core.function.objectiveC.assumeMessageSendTarget", "core.function.objectiveC.rewriteMessageSendTarget"],
 		"description" : "Replaces objc_msgSend calls with direct calls to the first found implementation when the target method is visible. May produce false positives when multiple classes implement the same selector or when selectors conflict with system framework methods."
 		})");
+	settings->RegisterSetting("analysis.objectiveC.resolveKnownReceivers",
+		R"({
+		"title" : "Resolve Calls on Known Receivers",
+		"type" : "boolean",
+		"default" : false,
+		"description" : "Replaces objc_msgSend calls with direct calls when the receiver's class is known from the surrounding code, such as the result of objc_alloc or +alloc, and the class or one of its superclasses in this binary implements the method. May produce false positives when a subclass or swizzled method takes over the call at runtime."
+		})");
+
+	BinaryNinja::PluginCommand::Register("Objective-C\\Log Plugin Memory Usage",
+		"Log the views with live Objective-C plugin state and their approximate sizes.",
+		[](BinaryNinja::BinaryView*) { GlobalState::logLiveViews(); });
+
+	BinaryNinja::PluginCommand::Register("Objective-C\\Log Performance Counters",
+		"Log the Objective-C workflow's performance counters for this view and store them in its metadata.",
+		[](BinaryNinja::BinaryView* view) { GlobalState::reportPerformance(view); });
 
 	return true;
 }
@@ -0,0 +1,104 @@
+#include "PointerTokenCache.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+using namespace BinaryNinja;
+
+namespace {
+
+/**
+ * Get the appropriate token type for a pointer to a given symbol.
+ */
+BNInstructionTextTokenType tokenTypeForSymbol(Ref<Symbol> symbol)
+{
+    switch (symbol->GetType()) {
+    case DataSymbol:
+        return DataSymbolToken;
+    case FunctionSymbol:
+        return CodeSymbolToken;
+    default:
+        return CodeRelativeAddressToken;
+    }
+}
+
+std::shared_ptr<const PointerToken> resolveToken(BinaryViewRef bv, uint64_t pointer)
+{
+    if (pointer == 0 || pointer == bv->GetStart())
+        return std::make_shared<const PointerToken>(PointerToken { KeywordToken, "NULL" });
+
+    if (Ref<Symbol> symbol = bv->GetSymbolByAddress(pointer))
+        return std::make_shared<const PointerToken>(PointerToken { tokenTypeForSymbol(symbol), symbol->GetFullName() });
+
+    char addressBuffer[32];
+    snprintf(addressBuffer, sizeof(addressBuffer), "0x%" PRIx64, pointer);
+    return std::make_shared<const PointerToken>(PointerToken { CodeRelativeAddressToken, addressBuffer });
+}
+
+} // unnamed namespace
+
+PointerTokenCache::PointerTokenCache()
+    : BinaryDataNotification(SymbolAdded | SymbolUpdated | SymbolRemoved)
+{
+}
+
+void PointerTokenCache::invalidate()
+{
+    m_generation.fetch_add(1, std::memory_order_acq_rel);
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_tokens.clear();
+}
+
+std::shared_ptr<const PointerToken> PointerTokenCache::token(BinaryViewRef bv, uint64_t pointer)
+{
+    const auto imageBase = bv->GetStart();
+    const auto generation = m_generation.load(std::memory_order_acquire);
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+
+        // Rebasing moves every symbol, and NULL is rendered for the base.
+        if (imageBase != m_imageBase) {
+            m_tokens.clear();
+            m_imageBase = imageBase;
+        }
+
+        if (const auto* token = m_tokens.find(pointer))
+            return *token;
+    }
+
+    // Resolve outside of the lock, and only cache the result if no symbol
+    // changed in the meantime.
+    auto token = resolveToken(bv, pointer);
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    if (m_generation.load(std::memory_order_acquire) == generation && m_imageBase == imageBase)
+        m_tokens.insert(pointer, token);
+    return token;
+}
+
+size_t PointerTokenCache::memoryUsage()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    // Each entry is a list node and an index node, each with two pointers of
+    // overhead, plus a bucket and the shared token with its control block;
+    // the text is usually stored inline.
+    constexpr size_t EntryBytes = sizeof(uint64_t) + sizeof(std::shared_ptr<const PointerToken>)
+        + 5 * sizeof(void*) + sizeof(uint64_t) + sizeof(PointerToken) + 2 * sizeof(void*);
+    return m_tokens.size() * EntryBytes + m_tokens.capacity() * sizeof(void*);
+}
+
+void PointerTokenCache::OnSymbolAdded(BinaryView*, Symbol*)
+{
+    invalidate();
+}
+
+void PointerTokenCache::OnSymbolUpdated(BinaryView*, Symbol*)
+{
+    invalidate();
+}
+
+void PointerTokenCache::OnSymbolRemoved(BinaryView*, Symbol*)
+{
+    invalidate();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "BinaryNinja.h"
+#include "LruCache.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * Token shown in place of a pointer by the data renderers.
+ */
+struct PointerToken {
+    BNInstructionTextTokenType type;
+    std::string text;
+};
+
+/**
+ * Per-view cache of the tokens rendered for pointers, so scrolling through
+ * large metadata tables doesn't look up and format the same symbols for
+ * every line on every repaint.
+ *
+ * The cache is registered as a notification on the view and clears itself
+ * whenever a symbol is added, changed or removed.
+ */
+class PointerTokenCache : public BinaryNinja::BinaryDataNotification {
+    /**
+     * Maximum number of tokens kept; a few screens' worth of a dense table
+     * many times over.
+     */
+    static constexpr size_t Capacity = 16384;
+
+    std::mutex m_lock;
+    LruCache<uint64_t, std::shared_ptr<const PointerToken>> m_tokens { Capacity };
+    uint64_t m_imageBase = 0;
+    std::atomic<uint64_t> m_generation = 0;
+
+    void invalidate();
+
+public:
+    PointerTokenCache();
+
+    /**
+     * Get the token for a pointer, resolving it on first use. Tokens are
+     * shared with the cache, so a hit doesn't copy the text.
+     */
+    std::shared_ptr<const PointerToken> token(BinaryViewRef, uint64_t pointer);
+
+    /**
+     * Get the approximate number of heap bytes used by the cache.
+     */
+    size_t memoryUsage();
+
+    void OnSymbolAdded(BinaryNinja::BinaryView*, BinaryNinja::Symbol*) override;
+    void OnSymbolUpdated(BinaryNinja::BinaryView*, BinaryNinja::Symbol*) override;
+    void OnSymbolRemoved(BinaryNinja::BinaryView*, BinaryNinja::Symbol*) override;
+};
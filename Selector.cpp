@@ -0,0 +1,205 @@
+#include "Selector.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+/**
+ * Number of components parsed without allocating; longer selectors are
+ * parsed again into a heap buffer.
+ */
+constexpr size_t InlineComponentCount = 16;
+
+bool isUpper(char c)
+{
+    return isupper(static_cast<unsigned char>(c));
+}
+
+bool isLower(char c)
+{
+    return islower(static_cast<unsigned char>(c));
+}
+
+char toLower(char c)
+{
+    return static_cast<char>(tolower(static_cast<unsigned char>(c)));
+}
+
+/**
+ * Get the leading word that may precede an argument name in a component,
+ * which is decided by the component's first character alone.
+ */
+constexpr std::string_view argumentPrefixFor(char first)
+{
+    switch (first) {
+    case 'a':
+        return "and";
+    case 'f':
+        return "for";
+    case 'i':
+        return "initWith";
+    case 'r':
+        return "read";
+    case 's':
+        return "set";
+    case 't':
+        return "to";
+    case 'u':
+        return "using";
+    case 'w':
+        return "with";
+    default:
+        return {};
+    }
+}
+
+/**
+ * Words that introduce an argument name in the middle of a component, as in
+ * `dataUsingEncoding` or `objectForKey`.
+ */
+constexpr std::string_view MiddleArgumentWords[] = { "With", "For", "Using" };
+
+/**
+ * Find the argument name following the last of the middle words in a
+ * component, if any.
+ */
+ArgumentName argumentNameAfterMiddleWord(std::string_view component)
+{
+    ArgumentName result;
+    size_t resultPosition = 0;
+
+    for (const auto word : MiddleArgumentWords) {
+        // The word can't start the component, since that is handled by the
+        // leading words, and must be followed by another capitalized word.
+        for (auto position = component.find(word, 1); position != std::string_view::npos;
+             position = component.find(word, position + 1)) {
+            if (position < resultPosition)
+                continue;
+
+            auto name = SelectorComponentWithoutPrefix(word, component.substr(position));
+            if (!name.empty()) {
+                result = name;
+                resultPosition = position;
+            }
+        }
+    }
+
+    return result;
+}
+
+} // unnamed namespace
+
+void ArgumentName::appendTo(std::string& out) const
+{
+    if (m_text.empty())
+        return;
+
+    out += m_lowercaseFirst ? toLower(m_text[0]) : m_text[0];
+    out.append(m_text.substr(1));
+}
+
+std::string ArgumentName::str() const
+{
+    std::string result;
+    result.reserve(m_text.size());
+    appendTo(result);
+    return result;
+}
+
+bool ArgumentName::operator==(std::string_view other) const
+{
+    if (m_text.size() != other.size())
+        return false;
+    if (m_text.empty())
+        return true;
+
+    const auto first = m_lowercaseFirst ? toLower(m_text[0]) : m_text[0];
+    return first == other[0] && m_text.substr(1) == other.substr(1);
+}
+
+size_t splitSelector(std::string_view selector, std::string_view* components, size_t capacity)
+{
+    size_t count = 0;
+
+    while (!selector.empty()) {
+        const auto end = selector.find(':');
+        const auto component = selector.substr(0, end);
+        if (!component.empty()) {
+            if (count < capacity)
+                components[count] = component;
+            ++count;
+        }
+
+        if (end == std::string_view::npos)
+            break;
+        selector.remove_prefix(end + 1);
+    }
+
+    return count;
+}
+
+ArgumentName SelectorComponentWithoutPrefix(std::string_view prefix, std::string_view component)
+{
+    if (component.size() <= prefix.size() || component.substr(0, prefix.size()) != prefix
+        || !isUpper(component[prefix.size()])) {
+        return {};
+    }
+
+    const auto result = component.substr(prefix.size());
+
+    // Lowercase the first character if the second character is not also uppercase.
+    // This ensures we leave initialisms such as `URL` alone.
+    return { result, result.size() > 1 && isLower(result[1]) };
+}
+
+ArgumentName ArgumentNameFromSelectorComponent(std::string_view component)
+{
+    if (const auto lastSpace = component.find_last_of(' '); lastSpace != std::string_view::npos)
+        component.remove_prefix(lastSpace + 1);
+    if (component.empty())
+        return {};
+
+    if (const auto prefix = argumentPrefixFor(component[0]); !prefix.empty()) {
+        if (auto argumentName = SelectorComponentWithoutPrefix(prefix, component); !argumentName.empty())
+            return argumentName;
+    }
+
+    if (auto argumentName = argumentNameAfterMiddleWord(component); !argumentName.empty())
+        return argumentName;
+
+    return { component, false };
+}
+
+SharedSelectorInfo ParseSelector(std::string text)
+{
+    static const auto invalid = std::make_shared<const SelectorInfo>();
+
+    // Selectors are identifiers joined by colons; anything else means the
+    // text was not read from a selector name.
+    auto isSelectorCharacter = [](char c) { return isprint(static_cast<unsigned char>(c)); };
+    if (text.empty() || !std::all_of(text.begin(), text.end(), isSelectorCharacter))
+        return invalid;
+
+    auto info = std::make_shared<SelectorInfo>();
+    info->valid = true;
+    info->argumentCount = std::count(text.begin(), text.end(), ':');
+
+    // Components are views into the record's own copy of the text, so it
+    // must not change after this point.
+    info->text = std::move(text);
+    std::string_view components[InlineComponentCount];
+    const auto componentCount = splitSelector(info->text, components, InlineComponentCount);
+    if (componentCount <= InlineComponentCount) {
+        info->components.assign(components, components + componentCount);
+    } else {
+        info->components.resize(componentCount);
+        splitSelector(info->text, info->components.data(), componentCount);
+    }
+
+    info->argumentNames.reserve(componentCount);
+    for (const auto component : info->components)
+        info->argumentNames.push_back(ArgumentNameFromSelectorComponent(component).str());
+
+    return info;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Argument name derived from a selector component, as a view into the
+ * component. Argument names are usually the component with its first
+ * character lowercased; rather than copying, the lowercasing is applied when
+ * the name is written out, so deriving a name never allocates.
+ */
+class ArgumentName {
+    std::string_view m_text;
+    bool m_lowercaseFirst = false;
+
+public:
+    constexpr ArgumentName() = default;
+    constexpr ArgumentName(std::string_view text, bool lowercaseFirst)
+        : m_text(text)
+        , m_lowercaseFirst(lowercaseFirst)
+    {
+    }
+
+    /**
+     * Get the text of the name as it appears in the selector.
+     */
+    constexpr std::string_view text() const { return m_text; }
+
+    /**
+     * Whether the first character is lowercased in the name.
+     */
+    constexpr bool lowercasesFirst() const { return m_lowercaseFirst; }
+
+    constexpr size_t size() const { return m_text.size(); }
+    constexpr bool empty() const { return m_text.empty(); }
+
+    /**
+     * Append the name to a string.
+     */
+    void appendTo(std::string& out) const;
+
+    /**
+     * Get the name as a string.
+     */
+    std::string str() const;
+
+    bool operator==(std::string_view other) const;
+    bool operator!=(std::string_view other) const { return !(*this == other); }
+};
+
+/**
+ * Split a selector into its colon-separated components, skipping empty ones.
+ *
+ * Up to `capacity` components are written to `components` as views into the
+ * selector. The total number of components is returned, which may be larger
+ * than `capacity`, in which case the caller can retry with a larger buffer.
+ */
+size_t splitSelector(std::string_view selector, std::string_view* components, size_t capacity);
+
+/**
+ * Given a selector component such as `initWithPath` and a prefix of
+ * `initWith`, returns the name `path`. Returns an empty name if the component
+ * does not start with the prefix followed by an uppercase character.
+ */
+ArgumentName SelectorComponentWithoutPrefix(std::string_view prefix, std::string_view component);
+
+/**
+ * Derive an argument name from a single selector component.
+ *
+ * Recognizes leading words such as `initWith`, `set` or `for` (`setTitle` ->
+ * `title`), and the words `With`, `For` and `Using` in the middle of a
+ * component (`objectForKey` -> `key`). Otherwise the last space-separated word
+ * of the component is used as is.
+ */
+ArgumentName ArgumentNameFromSelectorComponent(std::string_view component);
+
+/**
+ * Parsed form of a selector, shared by every call site that uses it.
+ *
+ * Records can't be copied or moved, since `components` points into `text`;
+ * they are only ever built in place by `ParseSelector`.
+ */
+struct SelectorInfo {
+    SelectorInfo() = default;
+    SelectorInfo(const SelectorInfo&) = delete;
+    SelectorInfo& operator=(const SelectorInfo&) = delete;
+
+    /**
+     * Whether the address this record was created for holds a readable
+     * selector. Invalid records are cached to avoid repeated reads; calls
+     * passing them are still given the generic call type.
+     */
+    bool valid = false;
+
+    std::string text;
+
+    /**
+     * Non-empty colon-separated components of the selector, as views into
+     * `text`.
+     */
+    std::vector<std::string_view> components;
+
+    size_t argumentCount = 0;
+    std::vector<std::string> argumentNames;
+};
+
+typedef std::shared_ptr<const SelectorInfo> SharedSelectorInfo;
+
+/**
+ * Parse a selector's text into a shared record. The record is invalid if the
+ * text is empty or has characters that can't appear in a selector.
+ */
+SharedSelectorInfo ParseSelector(std::string text);
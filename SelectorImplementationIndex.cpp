@@ -0,0 +1,177 @@
+#include "SelectorImplementationIndex.h"
+
+#include "Serialization.h"
+
+#include <algorithm>
+
+using namespace Serialization;
+
+namespace {
+
+/**
+ * Bits of filter per key; with a single hash this keeps the false positive
+ * rate around 12%, which is enough to skip most misses cheaply.
+ */
+constexpr size_t FilterBitsPerKey = 8;
+
+uint64_t mix(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return key;
+}
+
+/**
+ * Round a heap allocation up to the granularity of a typical allocator,
+ * including its bookkeeping word.
+ */
+size_t allocationSize(size_t bytes)
+{
+    return (bytes + sizeof(size_t) + 15) & ~size_t(15);
+}
+
+} // unnamed namespace
+
+void SelectorImplementationIndex::Builder::add(uint64_t key, const std::vector<uint64_t>& implementations)
+{
+    m_entries.push_back({ key, static_cast<uint32_t>(m_implementations.size()),
+        static_cast<uint32_t>(implementations.size()) });
+    m_implementations.insert(m_implementations.end(), implementations.begin(), implementations.end());
+}
+
+SelectorImplementationIndex SelectorImplementationIndex::Builder::build()
+{
+    // Sort by key, keeping insertion order for duplicates so the last entry
+    // for a key can be picked below.
+    std::stable_sort(m_entries.begin(), m_entries.end(),
+        [](const Entry& a, const Entry& b) { return a.key < b.key; });
+
+    SelectorImplementationIndex index;
+    index.m_keys.reserve(m_entries.size());
+    index.m_offsets.reserve(m_entries.size() + 1);
+    index.m_implementations.reserve(m_implementations.size());
+
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        const auto& entry = m_entries[i];
+        if (i + 1 < m_entries.size() && m_entries[i + 1].key == entry.key)
+            continue;
+
+        index.m_keys.push_back(entry.key);
+        index.m_offsets.push_back(static_cast<uint32_t>(index.m_implementations.size()));
+        index.m_implementations.insert(index.m_implementations.end(),
+            m_implementations.begin() + entry.start,
+            m_implementations.begin() + entry.start + entry.count);
+
+        // Node (next pointer, key, vector header) plus a bucket slot, plus
+        // the vector's own heap block.
+        index.m_legacyMemoryUsage += allocationSize(sizeof(void*) + sizeof(uint64_t) + sizeof(std::vector<uint64_t>))
+            + sizeof(void*);
+        if (entry.count)
+            index.m_legacyMemoryUsage += allocationSize(entry.count * sizeof(uint64_t));
+    }
+    index.m_offsets.push_back(static_cast<uint32_t>(index.m_implementations.size()));
+
+    size_t filterBits = 64;
+    while (filterBits < index.m_keys.size() * FilterBitsPerKey)
+        filterBits <<= 1;
+    index.m_filter.assign(filterBits / 64, 0);
+    index.m_filterMask = filterBits - 1;
+    for (auto key : index.m_keys) {
+        auto bit = mix(key) & index.m_filterMask;
+        index.m_filter[bit / 64] |= 1ULL << (bit % 64);
+    }
+
+    m_entries.clear();
+    m_implementations.clear();
+
+    return index;
+}
+
+void SelectorImplementationIndex::serialize(std::vector<uint8_t>& out) const
+{
+    writeValue(out, m_keys.size());
+    writeValue(out, m_implementations.size());
+    writeValue(out, m_filter.size());
+    writeValue(out, m_filterMask);
+    writeValue(out, m_legacyMemoryUsage);
+    writeArray(out, m_keys.data(), m_keys.size());
+    if (m_offsets.empty()) {
+        // A default-constructed index has no offsets at all; write the single
+        // offset an empty built index would have.
+        const uint32_t offset = 0;
+        writeArray(out, &offset, 1);
+    } else {
+        writeArray(out, m_offsets.data(), m_offsets.size());
+    }
+    writeArray(out, m_implementations.data(), m_implementations.size());
+    writeArray(out, m_filter.data(), m_filter.size());
+}
+
+std::optional<SelectorImplementationIndex> SelectorImplementationIndex::deserialize(
+    const uint8_t*& data, const uint8_t* end)
+{
+    uint64_t keyCount, implementationCount, filterWords, filterMask, legacyMemoryUsage;
+    if (!readValue(data, end, keyCount) || !readValue(data, end, implementationCount)
+        || !readValue(data, end, filterWords) || !readValue(data, end, filterMask)
+        || !readValue(data, end, legacyMemoryUsage)) {
+        return std::nullopt;
+    }
+
+    // The filter is either absent (empty index) or a power-of-two number of
+    // bits described by the mask.
+    if (filterWords ? filterMask + 1 != filterWords * 64 : filterMask != 0)
+        return std::nullopt;
+    if (keyCount >= UINT32_MAX || implementationCount > UINT32_MAX)
+        return std::nullopt;
+
+    SelectorImplementationIndex index;
+    if (!readArray(data, end, index.m_keys, keyCount)
+        || !readArray(data, end, index.m_offsets, keyCount + 1)
+        || !readArray(data, end, index.m_implementations, implementationCount)
+        || !readArray(data, end, index.m_filter, filterWords)) {
+        return std::nullopt;
+    }
+
+    // Offsets must describe valid spans, since lookups index with them
+    // directly.
+    if (index.m_offsets.front() != 0 || index.m_offsets.back() != implementationCount
+        || !std::is_sorted(index.m_offsets.begin(), index.m_offsets.end())) {
+        return std::nullopt;
+    }
+
+    index.m_filterMask = filterMask;
+    index.m_legacyMemoryUsage = legacyMemoryUsage;
+    return index;
+}
+
+bool SelectorImplementationIndex::mightContain(uint64_t key) const
+{
+    if (m_filter.empty())
+        return false;
+
+    auto bit = mix(key) & m_filterMask;
+    return m_filter[bit / 64] & (1ULL << (bit % 64));
+}
+
+ImplementationSpan SelectorImplementationIndex::find(uint64_t key) const
+{
+    if (!mightContain(key))
+        return {};
+
+    auto it = std::lower_bound(m_keys.begin(), m_keys.end(), key);
+    if (it == m_keys.end() || *it != key)
+        return {};
+
+    auto i = it - m_keys.begin();
+    const auto* base = m_implementations.data();
+    return { base + m_offsets[i], base + m_offsets[i + 1] };
+}
+
+size_t SelectorImplementationIndex::memoryUsage() const
+{
+    return m_keys.capacity() * sizeof(uint64_t)
+        + m_offsets.capacity() * sizeof(uint32_t)
+        + m_implementations.capacity() * sizeof(uint64_t)
+        + m_filter.capacity() * sizeof(uint64_t);
+}
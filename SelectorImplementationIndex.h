@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/**
+ * Non-owning view of a contiguous run of implementation addresses.
+ *
+ * Values are stored relative to some base, which is added back on access, so
+ * that an index built for one image base can serve any other.
+ */
+class ImplementationSpan {
+    const uint64_t* m_begin = nullptr;
+    const uint64_t* m_end = nullptr;
+    uint64_t m_base = 0;
+
+public:
+    ImplementationSpan() = default;
+    ImplementationSpan(const uint64_t* begin, const uint64_t* end, uint64_t base = 0)
+        : m_begin(begin)
+        , m_end(end)
+        , m_base(base)
+    {
+    }
+
+    /**
+     * Get the same span with `base` added to every value.
+     */
+    ImplementationSpan rebased(uint64_t base) const { return { m_begin, m_end, m_base + base }; }
+
+    size_t size() const { return m_end - m_begin; }
+    bool empty() const { return m_begin == m_end; }
+    uint64_t operator[](size_t i) const { return m_begin[i] + m_base; }
+};
+
+/**
+ * Immutable map from a selector (or selector reference) address to the
+ * addresses of the methods implementing it.
+ *
+ * Keys are stored sorted in one array, and the implementations for every key
+ * are packed back to back in a second array, indexed by an offset array (CSR
+ * layout). A small bitset filters out most misses before the binary search.
+ */
+class SelectorImplementationIndex {
+    std::vector<uint64_t> m_keys;
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint64_t> m_implementations;
+    std::vector<uint64_t> m_filter;
+    uint64_t m_filterMask = 0;
+    size_t m_legacyMemoryUsage = 0;
+
+    bool mightContain(uint64_t key) const;
+
+public:
+    /**
+     * Accumulates entries for an index, then packs them.
+     */
+    class Builder {
+        struct Entry {
+            uint64_t key;
+            uint32_t start;
+            uint32_t count;
+        };
+
+        std::vector<Entry> m_entries;
+        std::vector<uint64_t> m_implementations;
+
+    public:
+        /**
+         * Add the implementations for a key. If the same key is added more
+         * than once, the last set of implementations wins.
+         */
+        void add(uint64_t key, const std::vector<uint64_t>& implementations);
+
+        /**
+         * Pack the accumulated entries into an index.
+         */
+        SelectorImplementationIndex build();
+    };
+
+    /**
+     * Get the implementations for a key; empty if the key is not present.
+     */
+    ImplementationSpan find(uint64_t key) const;
+
+    /**
+     * Append the index to a buffer in a compact binary form that can be
+     * loaded back with `deserialize`. The encoding uses the host's byte order.
+     */
+    void serialize(std::vector<uint8_t>& out) const;
+
+    /**
+     * Load an index written by `serialize`, advancing `data` past it. Returns
+     * nothing if the data is truncated or inconsistent.
+     */
+    static std::optional<SelectorImplementationIndex> deserialize(const uint8_t*& data, const uint8_t* end);
+
+    /**
+     * Get the number of keys in the index.
+     */
+    size_t size() const { return m_keys.size(); }
+
+    /**
+     * Get the number of heap bytes used by the index.
+     */
+    size_t memoryUsage() const;
+
+    /**
+     * Get the estimated number of heap bytes the same data would use as an
+     * `std::unordered_map<uint64_t, std::vector<uint64_t>>`, for comparison.
+     */
+    size_t legacyMemoryUsage() const { return m_legacyMemoryUsage; }
+};
@@ -0,0 +1,126 @@
+#include "SelectorStrings.h"
+
+#include "Serialization.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+using namespace Serialization;
+
+void SelectorStrings::Builder::addNames(uint64_t start, const uint8_t* bytes, size_t size)
+{
+    m_sections.push_back({ start, size, m_text.size() });
+    m_text.insert(m_text.end(), bytes, bytes + size);
+    m_text.push_back('\0');
+}
+
+void SelectorStrings::Builder::addRef(uint64_t ref, uint64_t name)
+{
+    m_refs.emplace_back(ref, name);
+}
+
+SelectorStrings SelectorStrings::Builder::build()
+{
+    SelectorStrings result;
+
+    // Only the section list is sorted; each section keeps its place in the
+    // text buffer.
+    std::sort(m_sections.begin(), m_sections.end(),
+        [](const Section& a, const Section& b) { return a.start < b.start; });
+    result.m_sections = std::move(m_sections);
+    result.m_text = std::move(m_text);
+
+    std::stable_sort(m_refs.begin(), m_refs.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; });
+    m_refs.erase(std::unique(m_refs.begin(), m_refs.end(),
+                     [](const auto& a, const auto& b) { return a.first == b.first; }),
+        m_refs.end());
+
+    result.m_refs.reserve(m_refs.size());
+    result.m_names.reserve(m_refs.size());
+    for (const auto& [ref, name] : m_refs) {
+        result.m_refs.push_back(ref);
+        result.m_names.push_back(name);
+    }
+
+    m_refs.clear();
+    return result;
+}
+
+std::optional<std::string_view> SelectorStrings::text(uint64_t address) const
+{
+    auto it = std::upper_bound(m_sections.begin(), m_sections.end(), address,
+        [](uint64_t a, const Section& section) { return a < section.start; });
+    if (it == m_sections.begin())
+        return std::nullopt;
+
+    --it;
+    if (address - it->start >= it->size)
+        return std::nullopt;
+
+    // Every section is followed by a NUL, so the search always succeeds.
+    const auto* begin = m_text.data() + it->offset + (address - it->start);
+    const auto* end = static_cast<const char*>(std::memchr(begin, '\0', it->size - (address - it->start) + 1));
+    return std::string_view(begin, end - begin);
+}
+
+std::optional<uint64_t> SelectorStrings::nameForRef(uint64_t ref) const
+{
+    if (m_refs.empty() || ref < m_refs.front() || ref > m_refs.back())
+        return std::nullopt;
+
+    auto it = std::lower_bound(m_refs.begin(), m_refs.end(), ref);
+    if (it == m_refs.end() || *it != ref)
+        return std::nullopt;
+
+    return m_names[it - m_refs.begin()];
+}
+
+std::vector<uint64_t> SelectorStrings::referencedNames() const
+{
+    auto names = m_names;
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    return names;
+}
+
+void SelectorStrings::serialize(std::vector<uint8_t>& out) const
+{
+    writeValue(out, m_text.size());
+    writeValue(out, m_sections.size());
+    writeValue(out, m_refs.size());
+    writeArray(out, m_text.data(), m_text.size());
+    writeArray(out, m_sections.data(), m_sections.size());
+    writeArray(out, m_refs.data(), m_refs.size());
+    writeArray(out, m_names.data(), m_names.size());
+}
+
+std::optional<SelectorStrings> SelectorStrings::deserialize(const uint8_t*& data, const uint8_t* end)
+{
+    uint64_t textSize, sectionCount, refCount;
+    if (!readValue(data, end, textSize) || !readValue(data, end, sectionCount) || !readValue(data, end, refCount))
+        return std::nullopt;
+
+    SelectorStrings strings;
+    if (!readArray(data, end, strings.m_text, textSize) || !readArray(data, end, strings.m_sections, sectionCount)
+        || !readArray(data, end, strings.m_refs, refCount) || !readArray(data, end, strings.m_names, refCount)) {
+        return std::nullopt;
+    }
+
+    // Lookups rely on sorted sections and references, and on the NUL after
+    // every section to end the last string in it.
+    for (size_t i = 0; i < strings.m_sections.size(); ++i) {
+        const auto& section = strings.m_sections[i];
+        if (section.offset > strings.m_text.size() || section.size >= strings.m_text.size() - section.offset
+            || strings.m_text[section.offset + section.size] != '\0')
+            return std::nullopt;
+        if (i && strings.m_sections[i - 1].start > section.start)
+            return std::nullopt;
+    }
+    if (std::adjacent_find(strings.m_refs.begin(), strings.m_refs.end(), std::greater_equal<uint64_t>())
+        != strings.m_refs.end())
+        return std::nullopt;
+
+    return strings;
+}
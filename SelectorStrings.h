@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Immutable snapshot of a view's selector names and selector references.
+ *
+ * The contents of every `__objc_methname` section are copied into a single
+ * buffer, so a selector's text can be returned as a view into it, and each
+ * selector reference is mapped to the address of the name it points to.
+ * Neither lookup needs to read from the view.
+ */
+class SelectorStrings {
+    struct Section {
+        uint64_t start;
+        uint64_t size;
+
+        /**
+         * Position of the section's first byte in the text buffer.
+         */
+        size_t offset;
+    };
+
+    /**
+     * Contents of every section, each followed by a NUL so that a string at
+     * the end of a section is still terminated.
+     */
+    std::vector<char> m_text;
+
+    /**
+     * Sections in the text buffer, sorted by start address.
+     */
+    std::vector<Section> m_sections;
+
+    /**
+     * Sorted selector reference addresses, and the name address each one
+     * points to at the same position.
+     */
+    std::vector<uint64_t> m_refs;
+    std::vector<uint64_t> m_names;
+
+public:
+    class Builder {
+        std::vector<char> m_text;
+        std::vector<Section> m_sections;
+        std::vector<std::pair<uint64_t, uint64_t>> m_refs;
+
+    public:
+        /**
+         * Add the contents of a selector name section starting at `start`.
+         */
+        void addNames(uint64_t start, const uint8_t* bytes, size_t size);
+
+        /**
+         * Add a selector reference at `ref` pointing to the name at `name`.
+         * If the same reference is added more than once, the first wins.
+         */
+        void addRef(uint64_t ref, uint64_t name);
+
+        /**
+         * Pack the accumulated sections and references into a snapshot.
+         */
+        SelectorStrings build();
+    };
+
+    SelectorStrings() = default;
+
+    /**
+     * Get the NUL-terminated string at the given address, if it is inside
+     * one of the snapshotted sections.
+     */
+    std::optional<std::string_view> text(uint64_t address) const;
+
+    /**
+     * Get the address of the selector name the reference at the given
+     * address points to, if it is a known selector reference.
+     */
+    std::optional<uint64_t> nameForRef(uint64_t ref) const;
+
+    /**
+     * Get the address of every name pointed to by a selector reference,
+     * sorted and without duplicates.
+     */
+    std::vector<uint64_t> referencedNames() const;
+
+    /**
+     * Get the address of every selector reference, sorted.
+     */
+    const std::vector<uint64_t>& references() const { return m_refs; }
+
+    /**
+     * Append the snapshot to a buffer in a compact binary form that can be
+     * loaded back with `deserialize`. The encoding uses the host's byte order.
+     */
+    void serialize(std::vector<uint8_t>& out) const;
+
+    /**
+     * Load a snapshot written by `serialize`, advancing `data` past it.
+     * Returns nothing if the data is truncated or inconsistent.
+     */
+    static std::optional<SelectorStrings> deserialize(const uint8_t*& data, const uint8_t* end);
+
+    size_t textSize() const { return m_text.size(); }
+    size_t refCount() const { return m_refs.size(); }
+    size_t memoryUsage() const
+    {
+        return m_text.capacity() + m_sections.capacity() * sizeof(Section)
+            + (m_refs.capacity() + m_names.capacity()) * sizeof(uint64_t);
+    }
+};
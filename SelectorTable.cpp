@@ -0,0 +1,82 @@
+#include "SelectorTable.h"
+
+#include "GlobalState.h"
+
+#include <mutex>
+
+using namespace BinaryNinja;
+
+/**
+ * Maximum selector length to read, matching the previous per-call-site read.
+ */
+constexpr size_t MaxSelectorLength = 500;
+
+SharedSelectorInfo SelectorTable::parse(BinaryViewRef bv, uint64_t address, const AnalysisInfo* analysisInfo)
+{
+    static const auto invalid = std::make_shared<const SelectorInfo>();
+
+    std::string text;
+    if (auto snapshot = analysisInfo ? analysisInfo->selectorText(address) : std::nullopt) {
+        text.assign(snapshot->substr(0, MaxSelectorLength));
+    } else {
+        if (!bv->IsValidOffset(address))
+            return invalid;
+
+        try {
+            BinaryReader reader(bv);
+            reader.Seek(address);
+            text = reader.ReadCString(MaxSelectorLength);
+        } catch (ReadException&) {
+            return invalid;
+        }
+    }
+
+    return ParseSelector(std::move(text));
+}
+
+SharedSelectorInfo SelectorTable::selectorAt(BinaryViewRef bv, uint64_t address, const AnalysisInfo* analysisInfo)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(m_lock);
+        if (auto it = m_selectors.find(address); it != m_selectors.end()) {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+
+    // Parse outside of the lock; if another thread raced us to the same
+    // selector, keep whichever record was inserted first.
+    auto info = parse(bv, address, analysisInfo);
+
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    return m_selectors.emplace(address, std::move(info)).first->second;
+}
+
+size_t SelectorTable::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+    return m_selectors.size();
+}
+
+size_t SelectorTable::memoryUsage() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+
+    size_t bytes = m_selectors.bucket_count() * sizeof(void*);
+    for (const auto& [address, info] : m_selectors) {
+        bytes += sizeof(void*) + sizeof(address) + sizeof(info);
+
+        // Invalid entries all share one record.
+        if (!info->valid)
+            continue;
+
+        bytes += sizeof(SelectorInfo) + info->text.capacity();
+        bytes += info->components.capacity() * sizeof(std::string_view);
+        for (const auto& name : info->argumentNames)
+            bytes += sizeof(name) + name.capacity();
+    }
+
+    return bytes;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "BinaryNinja.h"
+#include "Selector.h"
+
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+struct AnalysisInfo;
+
+/**
+ * Per-view table of selectors, keyed by selector address.
+ *
+ * Each selector is read and parsed once, after which the immutable record is
+ * shared by all analysis threads.
+ */
+class SelectorTable {
+    mutable std::shared_mutex m_lock;
+    std::unordered_map<uint64_t, SharedSelectorInfo> m_selectors;
+
+    std::atomic<uint64_t> m_hits = 0;
+    std::atomic<uint64_t> m_misses = 0;
+
+    static SharedSelectorInfo parse(BinaryViewRef, uint64_t address, const AnalysisInfo*);
+
+public:
+    /**
+     * Get the selector at the given address, reading it on first use.
+     *
+     * The text is taken from the view's selector snapshot when the address
+     * is a selector name or reference it covers, and read from the view
+     * otherwise. Never returns null; check `valid` on the result instead.
+     *
+     * @param info The view's analysis info, if it has any
+     */
+    SharedSelectorInfo selectorAt(BinaryViewRef, uint64_t address, const AnalysisInfo* info);
+
+    /**
+     * Get the number of lookups answered from the table.
+     */
+    uint64_t hits() const { return m_hits.load(std::memory_order_relaxed); }
+
+    /**
+     * Get the number of lookups that required a read from the view.
+     */
+    uint64_t misses() const { return m_misses.load(std::memory_order_relaxed); }
+
+    /**
+     * Get the number of distinct addresses in the table.
+     */
+    size_t size() const;
+
+    /**
+     * Get the approximate number of heap bytes used by the table.
+     */
+    size_t memoryUsage() const;
+};
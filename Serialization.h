@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * Helpers for the compact binary form the immutable lookup tables are
+ * serialized to, for the database and for captures.
+ *
+ * Values and arrays are copied in the host's byte order, and every array is
+ * padded so the next one starts 8-byte aligned relative to the start of the
+ * buffer. Reads are bounds-checked against the end of the buffer and fail
+ * rather than read past it.
+ */
+namespace Serialization {
+
+template <typename T>
+inline void writeArray(std::vector<uint8_t>& out, const T* values, size_t count)
+{
+    const auto* bytes = reinterpret_cast<const uint8_t*>(values);
+    out.insert(out.end(), bytes, bytes + count * sizeof(T));
+
+    // Keep every array 8-byte aligned relative to the start of the buffer.
+    out.resize((out.size() + 7) & ~size_t(7));
+}
+
+inline void writeValue(std::vector<uint8_t>& out, uint64_t value)
+{
+    writeArray(out, &value, 1);
+}
+
+template <typename T>
+inline bool readArray(const uint8_t*& data, const uint8_t* end, std::vector<T>& values, uint64_t count)
+{
+    const auto available = static_cast<size_t>(end - data);
+    if (count > available / sizeof(T))
+        return false;
+
+    const auto size = static_cast<size_t>(count) * sizeof(T);
+    const auto paddedSize = (size + 7) & ~size_t(7);
+    if (paddedSize > available)
+        return false;
+
+    values.resize(count);
+    if (size)
+        std::memcpy(values.data(), data, size);
+    data += paddedSize;
+    return true;
+}
+
+inline bool readValue(const uint8_t*& data, const uint8_t* end, uint64_t& value)
+{
+    if (end - data < static_cast<std::ptrdiff_t>(sizeof(value)))
+        return false;
+
+    std::memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+    return true;
+}
+
+}
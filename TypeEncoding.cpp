@@ -0,0 +1,267 @@
+#include "TypeEncoding.h"
+
+namespace {
+
+/**
+ * Deepest nesting of pointers, arrays and aggregates decoded; anything deeper
+ * is treated as malformed.
+ */
+constexpr size_t MaxDepth = 32;
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/**
+ * Decodes one type at a time from the front of an encoding.
+ */
+class Decoder {
+    std::string_view m_text;
+
+    bool atEnd() const { return m_text.empty(); }
+    char peek() const { return m_text.front(); }
+    char take()
+    {
+        const auto c = m_text.front();
+        m_text.remove_prefix(1);
+        return c;
+    }
+
+    uint32_t number()
+    {
+        uint32_t value = 0;
+        while (!atEnd() && isDigit(peek()))
+            value = value * 10 + static_cast<uint32_t>(take() - '0');
+        return value;
+    }
+
+    /**
+     * Skip past the body of a struct, union or array whose opening bracket
+     * has already been taken, including the closing bracket. Quoted field
+     * names may contain any character, so brackets inside them are ignored.
+     */
+    bool skipAggregate()
+    {
+        size_t depth = 1;
+        while (!atEnd()) {
+            switch (take()) {
+            case '"':
+                while (!atEnd() && peek() != '"')
+                    take();
+                if (atEnd())
+                    return false;
+                take();
+                break;
+            case '{':
+            case '(':
+            case '[':
+                if (++depth > MaxDepth)
+                    return false;
+                break;
+            case '}':
+            case ')':
+            case ']':
+                if (--depth == 0)
+                    return true;
+                break;
+            default:
+                break;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Decode a struct or union whose opening bracket has already been taken.
+     */
+    bool aggregate(EncodedType& type, char close)
+    {
+        // The name runs up to the `=` before the fields, or to the closing
+        // bracket if the fields are omitted; `?` names an anonymous type.
+        size_t nameLength = 0;
+        while (nameLength < m_text.size() && m_text[nameLength] != '=' && m_text[nameLength] != close
+            && m_text[nameLength] != '{' && m_text[nameLength] != '(')
+            ++nameLength;
+        if (nameLength == m_text.size())
+            return false;
+
+        const auto name = m_text.substr(0, nameLength);
+        type.name = name == "?" ? std::string_view() : name;
+        m_text.remove_prefix(nameLength);
+        return skipAggregate();
+    }
+
+public:
+    explicit Decoder(std::string_view text)
+        : m_text(text)
+    {
+    }
+
+    bool done() const { return atEnd(); }
+
+    /**
+     * Decode the next type.
+     */
+    bool type(EncodedType& type, size_t depth = 0)
+    {
+        if (depth > MaxDepth)
+            return false;
+
+        // Qualifiers such as `const` (r) or `inout` (N) don't change how the
+        // value is passed.
+        while (!atEnd()) {
+            const auto c = peek();
+            if (c != 'r' && c != 'n' && c != 'N' && c != 'o' && c != 'O' && c != 'R' && c != 'V' && c != 'A')
+                break;
+            take();
+        }
+        if (atEnd())
+            return false;
+
+        type = {};
+        switch (take()) {
+        case 'v':
+            type.kind = EncodedTypeKind::Void;
+            return true;
+        case 'B':
+            type.kind = EncodedTypeKind::Bool;
+            return true;
+        case 'c':
+            type.kind = EncodedTypeKind::Char;
+            return true;
+        case 'C':
+            type.kind = EncodedTypeKind::UnsignedChar;
+            return true;
+        case 's':
+            type.kind = EncodedTypeKind::Short;
+            return true;
+        case 'S':
+            type.kind = EncodedTypeKind::UnsignedShort;
+            return true;
+        // `l` and `L` are always 32 bits in an encoding; 64-bit longs are
+        // encoded as `q` and `Q`.
+        case 'i':
+        case 'l':
+            type.kind = EncodedTypeKind::Int;
+            return true;
+        case 'I':
+        case 'L':
+            type.kind = EncodedTypeKind::UnsignedInt;
+            return true;
+        case 'q':
+            type.kind = EncodedTypeKind::LongLong;
+            return true;
+        case 'Q':
+            type.kind = EncodedTypeKind::UnsignedLongLong;
+            return true;
+        case 'f':
+            type.kind = EncodedTypeKind::Float;
+            return true;
+        case 'd':
+            type.kind = EncodedTypeKind::Double;
+            return true;
+        case 'D':
+            type.kind = EncodedTypeKind::LongDouble;
+            return true;
+        case '*':
+            type.kind = EncodedTypeKind::CString;
+            return true;
+        case '#':
+            type.kind = EncodedTypeKind::Class;
+            return true;
+        case ':':
+            type.kind = EncodedTypeKind::Selector;
+            return true;
+        case '?':
+            type.kind = EncodedTypeKind::Unknown;
+            return true;
+
+        case '@':
+            // Blocks are `@?`, and extended encodings name the class of an
+            // object in quotes, as in `@"NSString"`.
+            type.kind = EncodedTypeKind::Object;
+            if (!atEnd() && peek() == '?') {
+                take();
+            } else if (!atEnd() && peek() == '"') {
+                take();
+                const auto end = m_text.find('"');
+                if (end == std::string_view::npos)
+                    return false;
+                type.name = m_text.substr(0, end);
+                m_text.remove_prefix(end + 1);
+            }
+            return true;
+
+        case '^': {
+            EncodedType pointee;
+            if (!this->type(pointee, depth + 1))
+                return false;
+            type.kind = EncodedTypeKind::Pointer;
+            type.pointee = pointee.kind;
+            type.name = pointee.name;
+            return true;
+        }
+
+        case '{':
+            type.kind = EncodedTypeKind::Struct;
+            return aggregate(type, '}');
+        case '(':
+            type.kind = EncodedTypeKind::Union;
+            return aggregate(type, ')');
+
+        case '[': {
+            type.kind = EncodedTypeKind::Array;
+            type.count = number();
+            EncodedType element;
+            if (!this->type(element, depth + 1) || atEnd() || take() != ']')
+                return false;
+            type.pointee = element.kind;
+            type.name = element.name;
+            return true;
+        }
+
+        case 'b':
+            type.kind = EncodedTypeKind::Bitfield;
+            type.count = number();
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * Skip the stack offset that follows each type in a method encoding.
+     * Old encodings may mark register arguments with a sign.
+     */
+    void offset()
+    {
+        if (!atEnd() && (peek() == '+' || peek() == '-'))
+            take();
+        number();
+    }
+};
+
+} // unnamed namespace
+
+bool decodeMethodSignature(std::string_view encoding, MethodSignature& signature)
+{
+    Decoder decoder(encoding);
+    signature.argumentCount = 0;
+
+    if (!decoder.type(signature.returnType))
+        return false;
+    decoder.offset();
+
+    while (!decoder.done()) {
+        if (signature.argumentCount == MethodSignature::MaxArguments)
+            return false;
+        if (!decoder.type(signature.arguments[signature.argumentCount++]))
+            return false;
+        decoder.offset();
+    }
+
+    return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Kinds of values an Objective-C type encoding can describe.
+ */
+enum class EncodedTypeKind : uint8_t {
+    Unknown,
+    Void,
+    Bool,
+    Char,
+    UnsignedChar,
+    Short,
+    UnsignedShort,
+    Int,
+    UnsignedInt,
+    LongLong,
+    UnsignedLongLong,
+    Float,
+    Double,
+    LongDouble,
+    Object,
+    Class,
+    Selector,
+    CString,
+    Pointer,
+    Struct,
+    Union,
+    Array,
+    Bitfield,
+};
+
+/**
+ * A single type decoded from a type encoding.
+ *
+ * Nested types are not kept, other than the kind and name of the type a
+ * pointer points to, which is all a call type needs.
+ */
+struct EncodedType {
+    EncodedTypeKind kind = EncodedTypeKind::Unknown;
+
+    /**
+     * Kind of the type pointed to, for pointers.
+     */
+    EncodedTypeKind pointee = EncodedTypeKind::Unknown;
+
+    /**
+     * Name of the struct or union, or the one pointed to, or the class of an
+     * object if the encoding names it, as a view into the encoding. Empty if
+     * the type is anonymous.
+     */
+    std::string_view name;
+
+    /**
+     * Number of elements of an array, or bits of a bitfield.
+     */
+    uint32_t count = 0;
+};
+
+/**
+ * Types decoded from a method's type encoding, such as `v24@0:8@16`.
+ *
+ * The arguments include the receiver and selector, which every method takes
+ * first. Arguments are stored inline, so decoding never allocates.
+ */
+struct MethodSignature {
+    static constexpr size_t MaxArguments = 16;
+
+    EncodedType returnType;
+    EncodedType arguments[MaxArguments];
+    size_t argumentCount = 0;
+};
+
+/**
+ * Decode a method's type encoding. Returns false if the encoding is
+ * malformed or has more than `MethodSignature::MaxArguments` arguments.
+ */
+bool decodeMethodSignature(std::string_view encoding, MethodSignature& signature);
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+/**
+ * Read-mostly registry of per-view objects, keyed by view ID.
+ *
+ * Lookups are answered from a per-thread cache of the last entry found, which
+ * is validated against a generation counter that is bumped on every change to
+ * the registry. Analysis threads tend to work on the same view for long
+ * stretches, so nearly every lookup is a single relaxed load with no lock and
+ * no shared writes; only the first lookup after a change takes a shared lock.
+ *
+ * Entries are owned by the registry and returned as plain pointers, which stay
+ * valid until the entry is erased.
+ */
+template <typename T>
+class ViewRegistry {
+public:
+    using Key = std::size_t;
+
+private:
+    struct LookupCache {
+        uint64_t registry = 0;
+        uint64_t generation = 0;
+        Key key = 0;
+        T* value = nullptr;
+    };
+
+    mutable std::shared_mutex m_lock;
+    std::unordered_map<Key, std::unique_ptr<T>> m_entries;
+    std::atomic<uint64_t> m_generation = 1;
+
+    /**
+     * Unique ID of this registry, which the lookup cache is checked against
+     * rather than its address, since a registry may be created where an
+     * earlier one was destroyed.
+     */
+    const uint64_t m_id = nextId();
+
+    static uint64_t nextId()
+    {
+        static std::atomic<uint64_t> id = 0;
+        return id.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    static LookupCache& lookupCache()
+    {
+        static thread_local LookupCache cache;
+        return cache;
+    }
+
+    T* findSlow(Key key) const
+    {
+        auto generation = m_generation.load(std::memory_order_acquire);
+
+        T* value = nullptr;
+        {
+            std::shared_lock<std::shared_mutex> lock(m_lock);
+            if (auto it = m_entries.find(key); it != m_entries.end())
+                value = it->second.get();
+        }
+
+        // Only positive results are cached, so a view that is added later is
+        // always seen by the next lookup.
+        if (value)
+            lookupCache() = { m_id, generation, key, value };
+        return value;
+    }
+
+public:
+    /**
+     * Get the entry for a view, or null if there is none.
+     */
+    T* find(Key key) const
+    {
+        const auto& cache = lookupCache();
+        if (cache.registry == m_id && cache.key == key
+            && cache.generation == m_generation.load(std::memory_order_acquire))
+            return cache.value;
+
+        return findSlow(key);
+    }
+
+    /**
+     * Get the entry for a view, creating it with `factory` if needed. The
+     * factory must return a `std::unique_ptr<T>`.
+     */
+    template <typename Factory>
+    T* findOrCreate(Key key, Factory&& factory)
+    {
+        if (auto value = find(key))
+            return value;
+
+        std::unique_lock<std::shared_mutex> lock(m_lock);
+        auto& entry = m_entries[key];
+        if (!entry) {
+            entry = factory();
+            m_generation.fetch_add(1, std::memory_order_release);
+        }
+        return entry.get();
+    }
+
+    /**
+     * Remove and destroy the entry for a view, if any.
+     */
+    void erase(Key key)
+    {
+        std::unique_ptr<T> removed;
+        {
+            std::unique_lock<std::shared_mutex> lock(m_lock);
+            auto it = m_entries.find(key);
+            if (it == m_entries.end())
+                return;
+
+            removed = std::move(it->second);
+            m_entries.erase(it);
+            m_generation.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Call `visitor(key, entry)` for every entry in the registry.
+     */
+    template <typename Visitor>
+    void forEach(Visitor&& visitor) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_lock);
+        for (const auto& [key, entry] : m_entries)
+            visitor(key, *entry);
+    }
+
+    /**
+     * Get the number of entries in the registry.
+     */
+    size_t size() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_lock);
+        return m_entries.size();
+    }
+};
@@ -7,13 +7,18 @@
 
 #include "Workflow.h"
 
+#include "CallSite.h"
 #include "Constants.h"
+#include "FunctionMemo.h"
 #include "GlobalState.h"
 #include "Performance.h"
 #include "ArchitectureHooks.h"
 
 #include <lowlevelilinstruction.h>
 
+#include <algorithm>
+#include <cctype>
+#include <optional>
 #include <queue>
 #include "binaryninjaapi.h"
 
@@ -24,200 +29,360 @@ using SymbolRef = BinaryNinja::Ref<BinaryNinja::Symbol>;
 
 namespace {
 
-std::vector<std::string> splitSelector(const std::string& selector) {
-    std::vector<std::string> components;
-    std::istringstream stream(selector);
-    std::string component;
-
-    while (std::getline(stream, component, ':')) {
-        if (!component.empty()) {
-            components.push_back(component);
-        }
+/**
+ * What a scan of a function's candidate instructions found.
+ */
+struct CandidateScan {
+    bool hasCandidates = false;
+    ContentHash::Digest fingerprint;
+};
+
+/**
+ * Scan the calls and register assignments in a function's (non-SSA) LLIL,
+ * the only instructions the workflow rewrites or resolves call arguments
+ * from, checking if any constant in them falls inside the candidate filter.
+ *
+ * The same walk fingerprints those instructions: every expression's
+ * operation, size and operands are hashed, which covers its constants as well
+ * as its structure, since operands refer to subexpressions by index. Other
+ * instructions are only counted.
+ */
+CandidateScan scanCandidates(LLILFunctionRef llil, const AnalysisInfo& info)
+{
+    CandidateScan scan;
+    ContentHash hash;
+    const auto count = llil->GetInstructionCount();
+    hash.add(count);
+    for (size_t i = 0; i < count; ++i) {
+        const auto insn = llil->GetInstruction(i);
+        if (insn.operation != LLIL_CALL && insn.operation != LLIL_SET_REG)
+            continue;
+
+        hash.add(i);
+        hash.add(insn.address);
+        insn.VisitExprs([&](const BinaryNinja::LowLevelILInstruction& expr) {
+            hash.add((static_cast<uint64_t>(expr.operation) << 32) | expr.size);
+            for (const auto operand : expr.operands)
+                hash.add(operand);
+
+            switch (expr.operation) {
+            case LLIL_CONST:
+            case LLIL_CONST_PTR:
+            case LLIL_EXTERN_PTR:
+                if (!scan.hasCandidates)
+                    scan.hasCandidates = info.isCandidate(expr.GetConstant());
+                break;
+            default:
+                break;
+            }
+            return true;
+        });
     }
 
-    return components;
+    scan.fingerprint = hash.digest();
+    return scan;
 }
 
-// Given a selector component such as `initWithPath' and a prefix of `initWith`, returns `path`.
-std::optional<std::string> SelectorComponentWithoutPrefix(std::string_view prefix, std::string_view component)
+/**
+ * Regenerate the SSA form of a function if its IL was changed.
+ */
+void regenerateSSAIfChanged(LLILFunctionRef llil, bool isFunctionChanged)
 {
-    if (component.size() <= prefix.size() || component.rfind(prefix.data(), 0) != 0
-        || !isupper(component[prefix.size()])) {
-        return std::nullopt;
-    }
+    auto& sample = PerformanceSample::current();
 
-    std::string result(component.substr(prefix.size()));
+    // Applying call types doesn't touch the IL, so there is nothing for the
+    // SSA form to catch up on unless an instruction was replaced.
+    if (!isFunctionChanged)
+        return;
 
-    // Lowercase the first character if the second character is not also uppercase.
-    // This ensures we leave initialisms such as `URL` alone.
-    if (result.size() > 1 && islower(result[1]))
-        result[0] = tolower(result[0]);
+    // Updates found, regenerate SSA form
+    PhaseTimer timer(Phase::SSAGeneration);
+    sample.count(Counter::SSARegenerations);
+    llil->GenerateSSAForm();
+}
 
-    return result;
+/**
+ * Record a function whose instructions weren't looked at, if capturing, so
+ * the capture still accounts for every function analyzed.
+ */
+void captureSkippedFunction(BinaryViewRef bv, uint64_t start, uint8_t flags)
+{
+    if (const auto capture = GlobalState::captureWriter(bv)) {
+        Capture::FunctionRecord record;
+        record.session = bv->GetFile()->GetSessionId();
+        record.start = start;
+        record.flags = flags;
+        capture->write(record);
+    }
 }
 
-std::string ArgumentNameFromSelectorComponent(std::string component)
+/**
+ * Collects the current thread's performance sample for the duration of one
+ * function's analysis, and merges it into the view's counters when done.
+ */
+class SampleScope {
+    PerformanceCounters& m_counters;
+
+public:
+    explicit SampleScope(PerformanceCounters& counters)
+        : m_counters(counters)
+    {
+        PerformanceSample::current() = {};
+    }
+
+    ~SampleScope() { m_counters.merge(PerformanceSample::current()); }
+};
+
+/**
+ * Get the class of the object returned by sending a message to a receiver of
+ * a known class, for the few selectors that are known to return the receiver
+ * or a new instance of its class.
+ *
+ * Initializers are not followed, since a class cluster's `-init` may return
+ * an object of a different class than the one allocated.
+ */
+std::optional<ReceiverClass> classOfResult(const ReceiverClass& receiver, std::string_view selector)
 {
-    // TODO: Handle other common patterns such as <do some action>With<arg>: and <do some action>For<arg>:
-    for (const auto& prefix : { "initWith", "with", "and", "using", "set", "read", "to", "for" }) {
-        if (auto argumentName = SelectorComponentWithoutPrefix(prefix, component); argumentName.has_value())
-            return std::move(*argumentName);
+    if (receiver.isClassObject) {
+        if (selector == "alloc" || selector == "allocWithZone:")
+            return ReceiverClass { receiver.address, false };
+        return std::nullopt;
     }
 
-    return component;
+    if (selector == "retain" || selector == "autorelease")
+        return receiver;
+
+    return std::nullopt;
 }
 
-std::vector<std::string> generateArgumentNames(const std::vector<std::string>& components) {
-    std::vector<std::string> argumentNames;
+/**
+ * Tracks which registers hold an object of a known class through a basic
+ * block, starting from the results of calls that return one, such as
+ * `objc_alloc` or `+[Class alloc]`.
+ *
+ * Registers are tracked by their full-width register, so that a write to a
+ * sub-register such as `w0` or `eax` forgets the object held in `x0` or
+ * `rax`.
+ */
+class ReceiverTracker {
+    BinaryNinja::Ref<BinaryNinja::Architecture> m_arch;
+    std::vector<std::pair<uint32_t, ReceiverClass>> m_registers;
+
+    uint32_t fullWidth(uint32_t reg) const { return m_arch->GetRegisterInfo(reg).fullWidthRegister; }
 
-    for (const std::string& component : components) {
-        size_t startPos = component.find_last_of(" ");
-        std::string argumentName = (startPos == std::string::npos) ? component : component.substr(startPos + 1);
-        argumentNames.push_back(ArgumentNameFromSelectorComponent(std::move(argumentName)));
+public:
+    explicit ReceiverTracker(BinaryNinja::Ref<BinaryNinja::Architecture> arch)
+        : m_arch(std::move(arch))
+    {
     }
 
-    return argumentNames;
-}
+    void clear() { m_registers.clear(); }
 
-} // unnamed namespace
+    std::optional<ReceiverClass> find(uint32_t reg) const
+    {
+        reg = fullWidth(reg);
+        for (const auto& [tracked, cls] : m_registers)
+            if (tracked == reg)
+                return cls;
+        return std::nullopt;
+    }
 
-bool Workflow::rewriteMethodCall(LLILFunctionRef ssa, size_t insnIndex)
-{
-    auto function = ssa->GetFunction();
-    const auto bv = function->GetView();
-    const auto llil = ssa->GetNonSSAForm();
-    const auto insn = ssa->GetInstruction(insnIndex);
-    const auto params = insn.GetParameterExprs<LLIL_CALL_SSA>();
-
-    // The second parameter passed to the objc_msgSend call is the address of
-    // either the selector reference or the method's name, which in both cases
-    // is dereferenced to retrieve a selector.
-    if (params.size() < 2)
-        return false;
-    uint64_t rawSelector = 0;
-    if (params[1].operation == LLIL_REG_SSA)
+    void set(uint32_t reg, std::optional<ReceiverClass> cls)
     {
-        const auto selectorRegister = params[1].GetSourceSSARegister<LLIL_REG_SSA>();
-        rawSelector = ssa->GetSSARegisterValue(selectorRegister).value;
+        reg = fullWidth(reg);
+        m_registers.erase(std::remove_if(m_registers.begin(), m_registers.end(),
+                              [reg](const auto& entry) { return entry.first == reg; }),
+            m_registers.end());
+        if (cls)
+            m_registers.emplace_back(reg, *cls);
     }
-    else if (params[0].operation == LLIL_SEPARATE_PARAM_LIST_SSA)
+
+    /**
+     * Update the tracked registers for an instruction other than a call.
+     * Copies between full-width registers carry the class along; anything
+     * that may write registers in a way not understood here forgets all of
+     * them.
+     */
+    void update(const BinaryNinja::LowLevelILInstruction& insn)
     {
-        if (params[0].GetParameterExprs<LLIL_SEPARATE_PARAM_LIST_SSA>().size() == 0)
-        {
-            return false;
+        switch (insn.operation) {
+        case LLIL_SET_REG: {
+            const auto dest = insn.GetDestRegister<LLIL_SET_REG>();
+            const auto source = insn.GetSourceExpr<LLIL_SET_REG>();
+            std::optional<ReceiverClass> cls;
+            if (source.operation == LLIL_REG && fullWidth(dest) == dest) {
+                const auto sourceReg = source.GetSourceRegister<LLIL_REG>();
+                if (fullWidth(sourceReg) == sourceReg)
+                    cls = find(sourceReg);
+            }
+            set(dest, cls);
+            break;
+        }
+        case LLIL_SET_REG_SPLIT:
+            set(insn.GetHighRegister<LLIL_SET_REG_SPLIT>(), std::nullopt);
+            set(insn.GetLowRegister<LLIL_SET_REG_SPLIT>(), std::nullopt);
+            break;
+        case LLIL_STORE:
+        case LLIL_PUSH:
+        case LLIL_SET_FLAG:
+        case LLIL_NOP:
+        case LLIL_GOTO:
+        case LLIL_IF:
+            break;
+        default:
+            clear();
+            break;
         }
-        const auto selectorRegister = params[0].GetParameterExprs<LLIL_SEPARATE_PARAM_LIST_SSA>()[1].GetSourceSSARegister<LLIL_REG_SSA>();
-        rawSelector = ssa->GetSSARegisterValue(selectorRegister).value;
     }
-    if (rawSelector == 0)
-        return false;
+};
 
-    // -- Do callsite override
-    auto reader = BinaryNinja::BinaryReader(bv);
-    reader.Seek(rawSelector);
-    auto selector = reader.ReadCString(500);
-    auto additionalArgumentCount = std::count(selector.begin(), selector.end(), ':');
+/**
+ * Call site found in a function, with everything its rewrite is decided from
+ * already resolved.
+ */
+struct ResolvedSite {
+    size_t insnIndex = 0;
 
-    auto retType = bv->GetTypeByName({ "id" });
-    if (!retType)
-        retType = BinaryNinja::Type::PointerType(ssa->GetArchitecture(), BinaryNinja::Type::VoidType());
+    /**
+     * Kind of message send called, or `None` for a CFString reference.
+     */
+    CallTargetKind kind = CallTargetKind::None;
 
-    std::vector<BinaryNinja::FunctionParameter> callTypeParams;
-    auto cc = bv->GetDefaultPlatform()->GetDefaultCallingConvention();
+    /**
+     * The selector value passed to the call, or the address of the CFString's
+     * backing string.
+     */
+    uint64_t value = 0;
 
-    callTypeParams.push_back({"self", retType, true, BinaryNinja::Variable()});
+    SharedSelectorInfo selector;
+    std::optional<ReceiverClass> receiver;
+};
 
-    auto selType = bv->GetTypeByName({ "SEL" });
-    if (!selType)
-        selType = BinaryNinja::Type::PointerType(ssa->GetArchitecture(), BinaryNinja::Type::IntegerType(1, true));
-    callTypeParams.push_back({"sel", selType, true, BinaryNinja::Variable()});
+} // unnamed namespace
 
-    std::vector<std::string> selectorComponents = splitSelector(selector);
-    std::vector<std::string> argumentNames = generateArgumentNames(selectorComponents);
+bool Workflow::rewriteMethodCall(LLILFunctionRef llil, size_t insnIndex, CallTargetKind kind, uint64_t rawSelector,
+    const SharedSelectorInfo& selector, const ReceiverClass* receiver, const AnalysisInfo* info,
+    bool resolveDynamicDispatch, FunctionRewrites& rewrites)
+{
+    auto function = llil->GetFunction();
+    const auto bv = function->GetView();
+    auto insn = llil->GetInstruction(insnIndex);
 
-    for (size_t i = 0; i < additionalArgumentCount; i++)
+    // -- Do callsite override
+
+    // A selector that can't be read still gets the generic call type, with
+    // just the receiver and selector, and may still be resolved below.
+    TypeRef funcType;
     {
-        auto argType = BinaryNinja::Type::IntegerType(bv->GetAddressSize(), true);
-        if (argumentNames.size() > i && !argumentNames[i].empty())
-            callTypeParams.push_back({argumentNames[i], argType, true, BinaryNinja::Variable()});
-        else
-            callTypeParams.push_back({"arg" + std::to_string(i), argType, true, BinaryNinja::Variable()});
+        PhaseTimer timer(Phase::TypeBuilding);
+        const auto encoding = info && selector->valid ? info->methodEncoding(rawSelector) : std::nullopt;
+        funcType = GlobalState::callTypeCache(bv)->callType(bv, *selector, kind, encoding);
     }
-
-    auto funcType = BinaryNinja::Type::FunctionType(retType, cc, callTypeParams);
     function->SetAutoCallTypeAdjustment(function->GetArchitecture(), insn.address, {funcType, BN_DEFAULT_CONFIDENCE});
+    rewrites.callTypes.push_back({ insn.address, funcType });
     // --
 
-    if (!BinaryNinja::Settings::Instance()->Get<bool>("analysis.objectiveC.resolveDynamicDispatch", function))
+    // Super sends dispatch to the superclass's implementation, which the
+    // selector index can't tell apart from the others.
+    if (kind == CallTargetKind::MessageSendSuper || kind == CallTargetKind::MessageSendSuperStret)
         return false;
 
-    // Check the analysis info for a selector reference corresponding to the
-    // current selector. It is possible no such selector reference exists, for
-    // example, if the selector is for a method defined outside the current
-    // binary. If this is the case, there are no meaningful changes that can be
-    // made to the IL, and the operation should be aborted.
+    // A receiver whose class is in the image dispatches to whatever the
+    // class's flattened method table holds for the selector. A selector
+    // missing from the table is inherited from outside the image, and there
+    // is nothing in the view to call directly.
+    uint64_t implAddress = 0;
+    if (receiver && info && info->isClass(receiver->address)) {
+        const auto implementation
+            = info->methodImplementation(receiver->address, receiver->isClassObject, rawSelector);
+        if (!implementation)
+            return false;
+
+        PerformanceSample::current().count(Counter::ReceiverResolvedCalls);
+        implAddress = *implementation;
+    } else {
+        if (!resolveDynamicDispatch)
+            return false;
 
-    // k: also check direct selector value (x64 does this)
-    const auto info = GlobalState::analysisInfo(bv);
-    if (!info)
-        return false;
+        // Check the analysis info for a selector reference corresponding to the
+        // current selector. It is possible no such selector reference exists, for
+        // example, if the selector is for a method defined outside the current
+        // binary. If this is the case, there are no meaningful changes that can be
+        // made to the IL, and the operation should be aborted.
 
-    // Attempt to look up the implementation for the given selector, first by
-    // using the raw selector, then by the address of the selector reference. If
-    // the lookup fails in both cases, abort.
-    std::vector<uint64_t> imps;
-    if (const auto& it = info->selRefToImp.find(rawSelector); it != info->selRefToImp.end())
-        imps = it->second;
-    else if (const auto& iter = info->selToImp.find(rawSelector); iter != info->selToImp.end())
-        imps = iter->second;
+        // k: also check direct selector value (x64 does this)
+        if (!info)
+            return false;
 
-    if (imps.empty())
-        return false;
+        // Attempt to look up the implementation for the given selector, first by
+        // using the raw selector, then by the address of the selector reference. If
+        // the lookup fails in both cases, abort.
+        const auto imps = info->implementations(rawSelector);
+        if (imps.empty())
+            return false;
 
-    // k: This is the same behavior as before, however it is more apparent now by implementation
-    //      that we are effectively just guessing which method this hits. This has _obvious_ drawbacks,
-    //      but until we have more robust typing and objective-c type libraries, fixing this would
-    //      make the objective-c workflow do effectively nothing.
-    uint64_t implAddress = imps[0];
+        // k: This is the same behavior as before, however it is more apparent now by implementation
+        //      that we are effectively just guessing which method this hits. This has _obvious_ drawbacks,
+        //      but until we have more robust typing and objective-c type libraries, fixing this would
+        //      make the objective-c workflow do effectively nothing.
+        implAddress = imps[0];
+    }
     if (!implAddress)
         return false;
 
-    const auto llilIndex = ssa->GetNonSSAInstructionIndex(insnIndex);
-    auto llilInsn = llil->GetInstruction(llilIndex);
+    replaceCallDestination(llil, insnIndex, implAddress);
+    rewrites.replacements.push_back({ insnIndex, implAddress, false });
+
+    return true;
+}
+
+void Workflow::replaceCallDestination(LLILFunctionRef llil, size_t insnIndex, uint64_t implAddress)
+{
+    PhaseTimer timer(Phase::ILReplacement);
+    auto insn = llil->GetInstruction(insnIndex);
 
     // Change the destination expression of the LLIL_CALL operation to point to
     // the method implementation. This turns the "indirect call" piped through
     // `objc_msgSend` and makes it a normal C-style function call.
-    auto callDestExpr = llilInsn.GetDestExpr<LLIL_CALL>();
+    auto callDestExpr = insn.GetDestExpr<LLIL_CALL>();
     callDestExpr.Replace(llil->ConstPointer(callDestExpr.size, implAddress, callDestExpr));
-    llilInsn.Replace(llil->Call(callDestExpr.exprIndex, llilInsn));
-
-    return true;
+    insn.Replace(llil->Call(callDestExpr.exprIndex, insn));
 }
 
-bool Workflow::rewriteCFString(LLILFunctionRef ssa, size_t insnIndex)
+bool Workflow::rewriteCFString(LLILFunctionRef llil, size_t insnIndex, uint64_t stringAddress)
 {
-    const auto bv = ssa->GetFunction()->GetView();
-    const auto llil = ssa->GetNonSSAForm();
-    const auto insn = ssa->GetInstruction(insnIndex);
-    const auto llilIndex = ssa->GetNonSSAInstructionIndex(insnIndex);
-    auto llilInsn = llil->GetInstruction(llilIndex);
+    PhaseTimer timer(Phase::ILReplacement);
+    const auto bv = llil->GetFunction()->GetView();
+    auto llilInsn = llil->GetInstruction(insnIndex);
 
-    auto sourceExpr = insn.GetSourceExpr<LLIL_SET_REG_SSA>();
     auto destRegister = llilInsn.GetDestRegister();
 
-    auto addr = sourceExpr.GetValue().value;
-    auto stringPointer = addr + 0x10;
-    uint64_t dest;
-    bv->Read(&dest, stringPointer, bv->GetDefaultArchitecture()->GetAddressSize());
-
-    auto targetPointer = llil->ConstPointer(bv->GetAddressSize(), dest, llilInsn);
+    auto targetPointer = llil->ConstPointer(bv->GetAddressSize(), stringAddress, llilInsn);
     auto cfstrCall = llil->Intrinsic({ BinaryNinja::RegisterOrFlag(0, destRegister) }, CFSTRIntrinsicIndex, {targetPointer}, 0, llilInsn);
 
     llilInsn.Replace(cfstrCall);
     return true;
 }
 
+bool Workflow::reapplyRewrites(LLILFunctionRef llil, const FunctionRewrites& rewrites)
+{
+    auto function = llil->GetFunction();
+    const auto arch = function->GetArchitecture();
+    for (const auto& callType : rewrites.callTypes)
+        function->SetAutoCallTypeAdjustment(arch, callType.address, {callType.type, BN_DEFAULT_CONFIDENCE});
+
+    auto& sample = PerformanceSample::current();
+    for (const auto& replacement : rewrites.replacements) {
+        if (replacement.isCFString)
+            rewriteCFString(llil, replacement.insnIndex, replacement.target);
+        else
+            replaceCallDestination(llil, replacement.insnIndex, replacement.target);
+        sample.count(Counter::RewritesApplied);
+    }
+
+    return !rewrites.replacements.empty();
+}
+
 void Workflow::inlineMethodCalls(AnalysisContextRef ac)
 {
     const auto func = ac->GetFunction();
@@ -229,6 +394,11 @@ void Workflow::inlineMethodCalls(AnalysisContextRef ac)
 
     const auto log = BinaryNinja::LogRegistry::GetLogger(PluginLoggerName);
 
+    SampleScope sampleScope(GlobalState::performanceCounters(bv));
+    auto& sample = PerformanceSample::current();
+    sample.count(Counter::FunctionsVisited);
+    GlobalState::scheduleAnalysisReport(bv);
+
     // Ignore the view if it has an unsupported architecture.
     //
     // The reasoning for querying the default architecture here rather than the
@@ -247,12 +417,20 @@ void Workflow::inlineMethodCalls(AnalysisContextRef ac)
         return;
     }
 
-    if (auto info = GlobalState::analysisInfo(bv))
+    const auto info = GlobalState::analysisInfo(bv);
+    if (info)
     {
-        if (info->hasObjcStubs && func->GetStart() > info->objcStubsStartEnd.first && func->GetStart() < info->objcStubsStartEnd.second)
+        if (info->isObjcStub(func->GetStart()))
         {
-            func->SetAutoInlinedDuringAnalysis({true, BN_FULL_CONFIDENCE});
-            // Do no further cleanup, this is a stub and it will be cleaned up after inlining
+            // Calls to stubs whose selector could be decoded are rewritten
+            // directly in their callers (see below); only the rest need to be
+            // inlined for their `objc_msgSend` call to be seen. Most of those
+            // were already marked before analysis started (see
+            // `markStubsForInlining`), which spares their callers a second
+            // analysis pass.
+            if (!info->stubSelector(func->GetStart()) && !func->IsInlinedDuringAnalysis().GetValue())
+                func->SetAutoInlinedDuringAnalysis({true, BN_FULL_CONFIDENCE});
+            // Do no further cleanup in the stub itself
             return;
         }
     }
@@ -269,52 +447,300 @@ void Workflow::inlineMethodCalls(AnalysisContextRef ac)
         // log->LogError("(Workflow) Failed to get LLIL for 0x%llx", func->GetStart());
         return;
     }
-    const auto ssa = llil->GetSSAForm();
-    if (!ssa) {
-        // log->LogError("(Workflow) Failed to get LLIL SSA form for 0x%llx", func->GetStart());
-        return;
+
+    // Skip functions with nothing to rewrite before querying any dataflow.
+    // On ARM64 and x86-64, any address the rewrites act on shows up in the IL
+    // as a constant, or as the constant page of an ADRP. ARMv7 builds
+    // addresses from PC-relative MOVW/MOVT pairs, so no constant is visible
+    // until after dataflow and no function can be skipped there.
+    const auto archName = arch->GetName();
+    std::optional<CandidateScan> scan;
+    if (info && (archName == "aarch64" || archName == "x86_64")) {
+        {
+            PhaseTimer timer(Phase::Classification);
+            scan = scanCandidates(llil, *info);
+        }
+        if (!scan->hasCandidates) {
+            sample.count(Counter::FunctionsSkipped);
+            captureSkippedFunction(bv, func->GetStart(), Capture::FunctionRecord::Skipped);
+            return;
+        }
+    }
+
+    // Read once per function rather than once per call site; the setting can
+    // be overridden per function, so it can't be cached for the whole view.
+    const bool resolveDynamicDispatch = BinaryNinja::Settings::Instance()->Get<bool>(
+        "analysis.objectiveC.resolveDynamicDispatch", func);
+
+    // The selector is passed in the second integer argument register, or the
+    // third for the struct-returning variants, which take the result pointer
+    // first. The receiver is passed in the register before it.
+    std::vector<uint32_t> argumentRegisters;
+    std::optional<uint32_t> returnRegister;
+    if (const auto platform = func->GetPlatform()) {
+        if (const auto callingConvention = platform->GetDefaultCallingConvention()) {
+            argumentRegisters = callingConvention->GetIntegerArgumentRegisters();
+            returnRegister = callingConvention->GetIntegerReturnValueRegister();
+        }
+    }
+
+    // Receivers are only worth tracking if there are classes to resolve them
+    // against.
+    const bool trackReceivers = info && !info->tables->classes.empty() && returnRegister
+        && BinaryNinja::Settings::Instance()->Get<bool>("analysis.objectiveC.resolveKnownReceivers", func);
+
+    // A function analyzed again with the same calls and register assignments,
+    // tables and settings gets the same rewrites as last time, so they are
+    // applied again before any dataflow query, selector read or receiver
+    // tracking. The call type cache's generation covers edits to the types
+    // call types are built from. Only functions that were fingerprinted by
+    // the scan above are memoized.
+    auto* const memo = GlobalState::functionMemo(bv);
+    const auto capture = GlobalState::captureWriter(bv);
+    FunctionRewrites rewrites;
+    if (scan) {
+        {
+            PhaseTimer timer(Phase::Classification);
+            ContentHash inputs;
+            inputs.add(scan->fingerprint.first);
+            inputs.add(scan->fingerprint.second);
+            inputs.add(info->imageBase);
+            inputs.add(reinterpret_cast<uintptr_t>(info->tables.get()));
+            inputs.add(GlobalState::callTypeCache(bv)->generation());
+            inputs.add((resolveDynamicDispatch ? 1 : 0) | (trackReceivers ? 2 : 0));
+            rewrites.fingerprint = inputs.digest();
+        }
+
+        // An entry made while not capturing has no instructions to record,
+        // so it is only used once it has been made again.
+        const auto memoized = memo->find(func->GetStart(), rewrites.fingerprint);
+        if (memoized && (!capture || memoized->isCaptured)) {
+            sample.count(Counter::FunctionsMemoized);
+            if (capture) {
+                Capture::FunctionRecord record;
+                record.session = bv->GetFile()->GetSessionId();
+                record.start = func->GetStart();
+                record.flags = Capture::FunctionRecord::Memoized;
+                record.instructions = memoized->captured;
+                capture->write(record);
+            }
+            regenerateSSAIfChanged(llil, reapplyRewrites(llil, *memoized));
+            return;
+        }
     }
 
-    const auto rewriteIfEligible = [bv, messageHandler, ssa](size_t insnIndex) {
-        auto insn = ssa->GetInstruction(insnIndex);
+    // The selector and call type caches are filled ahead of time for every
+    // selector once initial analysis is done (see `prepareMethodCalls`), and
+    // filled again in the background if call types were invalidated or the
+    // view was rebased since.
+    if (info)
+        GlobalState::refreshMethodCalls(bv, *info);
+
+    ReceiverTracker receivers(arch);
+
+    // Get the class of the object passed in the given argument register,
+    // either tracked from an earlier call or a constant class address.
+    const auto receiverOf = [&](const BinaryNinja::LowLevelILInstruction& insn,
+                                size_t argumentIndex) -> std::optional<ReceiverClass> {
+        if (!trackReceivers || argumentRegisters.size() <= argumentIndex)
+            return std::nullopt;
+
+        const auto reg = argumentRegisters[argumentIndex];
+        if (auto tracked = receivers.find(reg))
+            return tracked;
+
+        const auto value = insn.GetRegisterValue(reg);
+        if ((value.state == ConstantValue || value.state == ConstantPointerValue) && info->isClass(value.value))
+            return ReceiverClass { static_cast<uint64_t>(value.value), true };
+        return std::nullopt;
+    };
+
+    // Get the selector passed at a call site.
+    const auto selectorOf = [&](uint64_t rawSelector) {
+        PhaseTimer timer(Phase::SelectorRead);
+        return GlobalState::selectorTable(bv)->selectorAt(bv, rawSelector, info.get());
+    };
+
+    // The calls and register assignments looked at below are recorded for
+    // offline replay if capturing is enabled. Only the arguments of calls to
+    // known targets are read, since nothing else is decided from them.
+    Capture::FunctionRecord captured;
+    const auto captureCall = [&](const BinaryNinja::LowLevelILInstruction& insn, uint64_t target, const CallSite& site,
+                                 const SelectorInfo* selector) {
+        Capture::Instruction call;
+        call.operation = Capture::Instruction::Operation::Call;
+        call.address = insn.address;
+        call.value = target;
+        if (site.kind != CallTargetKind::None) {
+            call.argumentCount = static_cast<uint8_t>(
+                std::min(argumentRegisters.size(), Capture::Instruction::MaxArguments));
+            for (size_t i = 0; i < call.argumentCount; ++i)
+                call.arguments[i] = insn.GetRegisterValue(argumentRegisters[i]).value;
+        }
+        if (selector && selector->valid)
+            call.selector = selector->text;
+        captured.instructions.push_back(std::move(call));
+    };
 
-        if (insn.operation == LLIL_CALL_SSA)
+    // Candidates are found directly on the non-SSA form, using the values the
+    // core's dataflow already has for it, so the SSA form is never walked and
+    // is only regenerated if the IL was actually changed.
+    //
+    // The first pass resolves everything a rewrite is decided from: call
+    // targets, selectors, receiver classes and CFString targets. Calls with a
+    // result of a known class report it through `callResult`.
+    std::vector<ResolvedSite> sites;
+    const auto resolve = [&](const BinaryNinja::LowLevelILInstruction& insn,
+                             std::optional<ReceiverClass>& callResult) {
+        const auto insnIndex = insn.instrIndex;
+
+        if (insn.operation == LLIL_CALL)
         {
-            // Filter out calls that aren't to `objc_msgSend`.
-            auto callExpr = insn.GetDestExpr<LLIL_CALL_SSA>();
-            bool isMessageSend = messageHandler->isMessageSend(callExpr.GetValue().value);
-            if (auto symbol = bv->GetSymbolByAddress(callExpr.GetValue().value))
-                isMessageSend = isMessageSend || symbol->GetRawName() == "_objc_msgSend";
-            if (!isMessageSend)
-                return false;
-
-            return rewriteMethodCall(ssa, insnIndex);
+            // Filter out calls that aren't to the `objc_msgSend` family.
+            auto callExpr = insn.GetDestExpr<LLIL_CALL>();
+            const auto target = callExpr.GetValue().value;
+            const auto site = classifyCallSite(messageHandler->getCallTargets(), info.get(), target,
+                argumentRegisters.size(), [&](size_t index) { return insn.GetRegisterValue(argumentRegisters[index]).value; });
+
+            // The selector is read once, for both the capture and the rewrite.
+            const auto selector = site.selector ? selectorOf(site.selector) : nullptr;
+            if (capture)
+                captureCall(insn, target, site, selector.get());
+
+            if (site.kind == CallTargetKind::None)
+                return;
+
+            // Runtime functions that return an object of a known class are
+            // left alone, other than noting the class of their result.
+            if (site.kind == CallTargetKind::Allocate || site.kind == CallTargetKind::ClassOf) {
+                const auto argument = receiverOf(insn, 0);
+                if (argument && (site.kind == CallTargetKind::ClassOf || argument->isClassObject))
+                    callResult = ReceiverClass { argument->address, site.kind == CallTargetKind::ClassOf };
+                return;
+            }
+            sample.count(Counter::MessageSendCandidates);
+
+            // Stubs that couldn't be decoded are inlined into their callers
+            // (see above), after which the `objc_msgSend` call inside them is
+            // handled here.
+            //
+            // Otherwise, the selector passed is the address of either the
+            // selector reference or the method's name, which in both cases
+            // is dereferenced to retrieve a selector.
+            if (site.kind == CallTargetKind::SelectorStub || site.selector == 0)
+                return;
+
+            ResolvedSite resolved;
+            resolved.insnIndex = insnIndex;
+            resolved.kind = site.kind;
+            resolved.value = site.selector;
+            resolved.selector = selector;
+
+            // Super sends take a structure rather than the receiver itself.
+            if (site.kind == CallTargetKind::MessageSend || site.kind == CallTargetKind::MessageSendStret) {
+                resolved.receiver = receiverOf(insn, site.receiverArgument);
+                if (resolved.receiver && resolved.selector->valid)
+                    callResult = classOfResult(*resolved.receiver, resolved.selector->text);
+            }
+            sites.push_back(std::move(resolved));
         }
-        else if (insn.operation == LLIL_SET_REG_SSA)
+        else if (insn.operation == LLIL_SET_REG)
         {
-            auto sourceExpr = insn.GetSourceExpr<LLIL_SET_REG_SSA>();
+            if (!info)
+                return;
+
+            auto sourceExpr = insn.GetSourceExpr<LLIL_SET_REG>();
             auto addr = sourceExpr.GetValue().value;
-            BinaryNinja::DataVariable var;
-            if (!bv->GetDataVariableAtAddress(addr, var) || var.type->GetString() != "struct CFString")
-                return false;
+            if (capture) {
+                Capture::Instruction assignment;
+                assignment.operation = Capture::Instruction::Operation::SetRegister;
+                assignment.address = insn.address;
+                assignment.value = addr;
+                captured.instructions.push_back(std::move(assignment));
+            }
+
+            const auto stringAddress = info->cfString(addr);
+            if (!stringAddress)
+                return;
+            sample.count(Counter::CFStringCandidates);
+
+            ResolvedSite resolved;
+            resolved.insnIndex = insnIndex;
+            resolved.value = *stringAddress;
+            sites.push_back(std::move(resolved));
+        }
+    };
+
+    const auto instructionCount = llil->GetInstructionCount();
+    sample.count(Counter::InstructionsScanned, instructionCount);
+
+    // Receivers are tracked through one basic block at a time.
+    std::vector<size_t> blockStarts;
+    if (trackReceivers) {
+        for (const auto& block : llil->GetBasicBlocks())
+            blockStarts.push_back(block->GetStart());
+        std::sort(blockStarts.begin(), blockStarts.end());
+    }
+    auto nextBlockStart = blockStarts.begin();
 
-            return rewriteCFString(ssa, insnIndex);
+    for (size_t i = 0; i < instructionCount; ++i) {
+        const auto insn = llil->GetInstruction(i);
+        if (nextBlockStart != blockStarts.end() && *nextBlockStart == i) {
+            receivers.clear();
+            ++nextBlockStart;
         }
 
-        return false;
-    };
+        std::optional<ReceiverClass> callResult;
+        resolve(insn, callResult);
+
+        if (!trackReceivers)
+            continue;
 
+        // A call may clobber any register, and leaves its result, if it is of
+        // a known class, in the return value register.
+        if (insn.operation == LLIL_CALL || insn.operation == LLIL_CALL_STACK_ADJUST) {
+            receivers.clear();
+            receivers.set(*returnRegister, callResult);
+        } else {
+            receivers.update(insn);
+        }
+    }
+
+    if (capture) {
+        captured.session = bv->GetFile()->GetSessionId();
+        captured.start = func->GetStart();
+        capture->write(captured);
+    }
+
+    // The second pass makes the rewrites.
     bool isFunctionChanged = false;
-    for (const auto& block : ssa->GetBasicBlocks())
-        for (size_t i = block->GetStart(), end = block->GetEnd(); i < end; ++i)
-            if (rewriteIfEligible(i))
-                isFunctionChanged = true;
+    for (const auto& site : sites) {
+        bool isRewritten;
+        if (site.kind == CallTargetKind::None) {
+            isRewritten = rewriteCFString(llil, site.insnIndex, site.value);
+            if (isRewritten)
+                rewrites.replacements.push_back({ site.insnIndex, site.value, true });
+        } else {
+            isRewritten = rewriteMethodCall(llil, site.insnIndex, site.kind, site.value, site.selector,
+                site.receiver ? &*site.receiver : nullptr, info.get(), resolveDynamicDispatch, rewrites);
+        }
 
-    if (!isFunctionChanged)
-        return;
+        if (isRewritten) {
+            sample.count(Counter::RewritesApplied);
+            isFunctionChanged = true;
+        }
+    }
 
-    // Updates found, regenerate SSA form
-    llil->GenerateSSAForm();
+    // Functions with no call sites are left out of the memo, so they don't
+    // crowd out the ones with rewrites to reapply.
+    if (scan && !sites.empty()) {
+        if (capture) {
+            rewrites.isCaptured = true;
+            rewrites.captured = std::move(captured.instructions);
+        }
+        memo->insert(func->GetStart(), std::make_shared<FunctionRewrites>(std::move(rewrites)));
+    }
+    regenerateSSAIfChanged(llil, isFunctionChanged);
 }
 
 static constexpr auto WorkflowInfo = R"({
@@ -323,6 +749,50 @@ static constexpr auto WorkflowInfo = R"({
   "capabilities": []
 })";
 
+void Workflow::markStubsForInlining(BinaryNinja::BinaryView* view)
+{
+    BinaryViewRef bv = view;
+    if (!GlobalState::hasAnalysisInfo(bv) || GlobalState::viewIsIgnored(bv))
+        return;
+
+    const auto platform = bv->GetDefaultPlatform();
+    if (!platform)
+        return;
+
+    // This runs before analysis starts, so only the stub sections are read;
+    // the analysis info is left to be built when the first function needs it.
+    size_t marked = 0;
+    for (const auto address : GlobalState::undecodedSelectorStubs(bv)) {
+        auto func = bv->GetAnalysisFunction(platform, address);
+        if (!func) {
+            bv->AddFunctionForAnalysis(platform, address);
+            func = bv->GetAnalysisFunction(platform, address);
+        }
+        if (!func || func->IsInlinedDuringAnalysis().GetValue())
+            continue;
+
+        func->SetAutoInlinedDuringAnalysis({true, BN_FULL_CONFIDENCE});
+        ++marked;
+    }
+
+    BinaryNinja::LogRegistry::GetLogger(PluginLoggerName)->LogDebug(
+        "Marked %zu Objective-C stubs for inlining", marked);
+}
+
+void Workflow::prepareMethodCalls(BinaryNinja::BinaryView* view)
+{
+    BinaryViewRef bv = view;
+    if (!GlobalState::hasAnalysisInfo(bv) || GlobalState::viewIsIgnored(bv))
+        return;
+
+    try {
+        GlobalState::prepareMethodCalls(bv);
+    } catch (std::exception& e) {
+        BinaryNinja::LogRegistry::GetLogger(PluginLoggerName)->LogError(
+            "Failed to prepare method calls: %s", e.what());
+    }
+}
+
 void Workflow::registerActivities()
 {
     const auto wf = BinaryNinja::Workflow::Instance("core.function.baseAnalysis")->Clone("core.function.objectiveC");
@@ -331,4 +801,10 @@ void Workflow::registerActivities()
     wf->Insert("core.function.translateTailCalls", ActivityID::ResolveMethodCalls);
 
     BinaryNinja::Workflow::RegisterWorkflow(wf, WorkflowInfo);
+
+    // Stub pass, run once per view before its functions are analyzed.
+    BinaryNinja::BinaryViewType::RegisterBinaryViewFinalizationEvent(&Workflow::markStubsForInlining);
+
+    // View-wide pre-pass, run once per view after initial analysis.
+    BinaryNinja::BinaryViewType::RegisterBinaryViewInitialAnalysisCompletionEvent(&Workflow::prepareMethodCalls);
 }
@@ -8,6 +8,11 @@
 #pragma once
 
 #include "BinaryNinja.h"
+#include "CallTargetTable.h"
+#include "Selector.h"
+
+struct AnalysisInfo;
+struct FunctionRewrites;
 
 /**
  * Namespace to hold activity ID constants.
@@ -18,6 +23,18 @@ constexpr auto ResolveMethodCalls = "core.function.objectiveC.resolveMethodCalls
 
 }
 
+/**
+ * Class of the receiver of a message send, when it is known.
+ */
+struct ReceiverClass {
+    uint64_t address = 0;
+
+    /**
+     * Whether the receiver is the class itself rather than an instance of it.
+     */
+    bool isClassObject = false;
+};
+
 /**
  * Workflow-related procedures.
  */
@@ -27,16 +44,40 @@ class Workflow {
      * Attempt to rewrite the `objc_msgSend` call at `insnIndex` with a direct
      * call to the requested method's implementation.
      *
-     * @param insnIndex The index of the `LLIL_CALL` instruction to rewrite
+     * @param insnIndex The index of the (non-SSA) `LLIL_CALL` instruction to rewrite
+     * @param kind The kind of message send being called
+     * @param rawSelector The selector value passed to the call
+     * @param selector The selector read from `rawSelector`
+     * @param receiver The class of the receiver, if it is known
+     * @param info The view's analysis info, if it has any
+     * @param resolveDynamicDispatch Whether to replace the call destination
+     * @param rewrites The function's rewrites, which any changes made are added to
+     */
+    static bool rewriteMethodCall(LLILFunctionRef, size_t insnIndex, CallTargetKind kind, uint64_t rawSelector,
+        const SharedSelectorInfo& selector, const ReceiverClass* receiver, const AnalysisInfo* info,
+        bool resolveDynamicDispatch, FunctionRewrites& rewrites);
+
+    /**
+     * Replace the destination of the `LLIL_CALL` instruction at `insnIndex`
+     * with a direct call to `implAddress`.
      */
-    static bool rewriteMethodCall(LLILFunctionRef, size_t insnIndex);
+    static void replaceCallDestination(LLILFunctionRef, size_t insnIndex, uint64_t implAddress);
 
     /**
      * Rewrite a CFString reference to a direct string reference and matching CFSTR intrinsic call.
      *
-     * @param insnIndex The index of the `LLIL_CALL` instruction to rewrite
+     * @param insnIndex The index of the (non-SSA) `LLIL_SET_REG` instruction to rewrite
+     * @param stringAddress The address of the CFString's backing string
      */
-    static bool rewriteCFString(LLILFunctionRef, size_t insnIndex);
+    static bool rewriteCFString(LLILFunctionRef, size_t insnIndex, uint64_t stringAddress);
+
+    /**
+     * Apply the rewrites remembered for a function again, to IL identical to
+     * the IL they were decided from.
+     *
+     * @return Whether any instruction was replaced
+     */
+    static bool reapplyRewrites(LLILFunctionRef, const FunctionRewrites&);
 
 public:
     /**
@@ -44,6 +85,20 @@ public:
      */
     static void inlineMethodCalls(AnalysisContextRef);
 
+    /**
+     * Mark the view's `__objc_stubs` stubs that must be inlined as such before
+     * its functions are analyzed, so callers don't need to be analyzed again
+     * once each stub is found to be a stub.
+     */
+    static void markStubsForInlining(BinaryNinja::BinaryView*);
+
+    /**
+     * Fill the view's selector and call type caches for every selector it
+     * references, once initial analysis is done, so re-analysis finds them
+     * ready.
+     */
+    static void prepareMethodCalls(BinaryNinja::BinaryView*);
+
     /**
      * Register the Objective Ninja workflow and all activities.
      *
@@ -0,0 +1,43 @@
+#include "Test.h"
+
+#include "CFStringIndex.h"
+
+#include <utility>
+#include <vector>
+
+TEST(cfStringIndexFindsEntries)
+{
+    // Entries are given out of order, as they are read from the sections.
+    const CFStringIndex index({ { 0x3020, 0x500 }, { 0x3000, 0x400 }, { 0x3040, 0x600 } });
+    CHECK(index.size() == 3);
+
+    CHECK(index.find(0x3000) == 0x400);
+    CHECK(index.find(0x3020) == 0x500);
+    CHECK(index.find(0x3040) == 0x600);
+
+    // Inside the span but between entries, and on either side of it.
+    CHECK(!index.find(0x3010));
+    CHECK(!index.find(0x2ff8));
+    CHECK(!index.find(0x3048));
+    CHECK(!index.find(0));
+
+    std::vector<uint64_t> addresses;
+    index.forEach([&](uint64_t address, uint64_t) { addresses.push_back(address); });
+    CHECK((addresses == std::vector<uint64_t> { 0x3000, 0x3020, 0x3040 }));
+}
+
+TEST(cfStringIndexKeepsOneEntryPerAddress)
+{
+    const CFStringIndex index({ { 0x3000, 0x400 }, { 0x3000, 0x410 }, { 0x3020, 0x500 } });
+    CHECK(index.size() == 2);
+
+    const auto string = index.find(0x3000);
+    CHECK(string == 0x400 || string == 0x410);
+}
+
+TEST(cfStringIndexEmpty)
+{
+    const CFStringIndex index;
+    CHECK(index.empty());
+    CHECK(!index.find(0x3000));
+}
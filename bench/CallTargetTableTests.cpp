@@ -0,0 +1,64 @@
+#include "Test.h"
+
+#include "CallTargetTable.h"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+TEST(callTargetTableFindsEveryEntry)
+{
+    // Enough entries that many probe sequences run into each other and wrap
+    // around the end of the table.
+    std::vector<std::pair<uint64_t, CallTargetKind>> targets;
+    for (uint64_t i = 1; i <= 1000; ++i)
+        targets.emplace_back(0x100000000 + i * 0x10, i % 2 ? CallTargetKind::MessageSend : CallTargetKind::Allocate);
+
+    const CallTargetTable table(targets);
+    CHECK(table.size() == targets.size());
+    for (const auto& [address, kind] : targets)
+        CHECK(table.classify(address) == kind);
+
+    // Addresses between and past the entries are not found.
+    for (uint64_t i = 1; i <= 1000; ++i)
+        CHECK(table.classify(0x100000000 + i * 0x10 + 8) == CallTargetKind::None);
+    CHECK(table.classify(0) == CallTargetKind::None);
+}
+
+TEST(callTargetTableKeepsFirstKind)
+{
+    const CallTargetTable table({
+        { 0x1000, CallTargetKind::MessageSendSuper },
+        { 0x1000, CallTargetKind::MessageSend },
+        { 0, CallTargetKind::MessageSend },
+        { 0x2000, CallTargetKind::None },
+    });
+
+    CHECK(table.size() == 1);
+    CHECK(table.classify(0x1000) == CallTargetKind::MessageSendSuper);
+    CHECK(table.classify(0x2000) == CallTargetKind::None);
+
+    std::map<uint64_t, CallTargetKind> visited;
+    table.forEach([&](uint64_t address, CallTargetKind kind) { visited[address] = kind; });
+    CHECK((visited == std::map<uint64_t, CallTargetKind> { { 0x1000, CallTargetKind::MessageSendSuper } }));
+}
+
+TEST(callTargetTableEmpty)
+{
+    const CallTargetTable defaulted;
+    CHECK(defaulted.empty());
+    CHECK(defaulted.classify(0x1000) == CallTargetKind::None);
+
+    const CallTargetTable built(std::vector<std::pair<uint64_t, CallTargetKind>> {});
+    CHECK(built.empty());
+    CHECK(built.classify(0x1000) == CallTargetKind::None);
+}
+
+TEST(messageSendFamily)
+{
+    CHECK(isMessageSend(CallTargetKind::MessageSend));
+    CHECK(isMessageSend(CallTargetKind::MessageSendSuperStret));
+    CHECK(!isMessageSend(CallTargetKind::SelectorStub));
+    CHECK(!isMessageSend(CallTargetKind::Allocate));
+    CHECK(!isMessageSend(CallTargetKind::None));
+}
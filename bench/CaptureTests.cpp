@@ -0,0 +1,110 @@
+#include "Test.h"
+
+#include "Capture.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static std::string temporaryPath(const char* name)
+{
+    const char* directory = std::getenv("TMPDIR");
+    return std::string(directory ? directory : "/tmp") + "/workflow_objc_tests_" + name;
+}
+
+TEST(captureRoundTrip)
+{
+    const auto path = temporaryPath("roundtrip.capture");
+
+    Capture::ViewRecord view;
+    view.session = 7;
+    view.imageBase = 0x100000000;
+    view.callTargets = { { 0x100001000, CallTargetKind::MessageSend } };
+    view.cfStrings = { { 0x10, 0x20 } };
+    view.selectorStrings = { 1, 2, 3 };
+
+    Capture::FunctionRecord function;
+    function.session = 7;
+    function.start = 0x100002000;
+    function.flags = Capture::FunctionRecord::Memoized;
+
+    Capture::Instruction call;
+    call.address = 0x100002004;
+    call.value = 0x100001000;
+    call.argumentCount = 2;
+    call.arguments[0] = 0x30;
+    call.arguments[1] = 0x40;
+    call.selector = "objectForKey:";
+    function.instructions.push_back(call);
+
+    Capture::Instruction assignment;
+    assignment.operation = Capture::Instruction::Operation::SetRegister;
+    assignment.address = 0x100002008;
+    assignment.value = 0x10;
+    function.instructions.push_back(assignment);
+
+    {
+        Capture::Writer writer(path);
+        writer.write(view);
+        writer.write(function);
+    }
+
+    Capture::Reader reader(path);
+    CHECK(reader.isOpen());
+
+    Capture::RecordType type;
+    Capture::ViewRecord readView;
+    Capture::FunctionRecord readFunction;
+    CHECK(reader.next(type, readView, readFunction));
+    CHECK(type == Capture::RecordType::View);
+    CHECK(readView.session == 7 && readView.imageBase == view.imageBase);
+    CHECK(readView.callTargets == view.callTargets);
+    CHECK(readView.cfStrings == view.cfStrings);
+    CHECK(readView.selectorStrings == view.selectorStrings);
+
+    CHECK(reader.next(type, readView, readFunction));
+    CHECK(type == Capture::RecordType::Function);
+    CHECK(readFunction.start == function.start);
+    CHECK(readFunction.flags == Capture::FunctionRecord::Memoized);
+    CHECK(readFunction.instructions.size() == 2);
+    if (readFunction.instructions.size() == 2) {
+        const auto& readCall = readFunction.instructions[0];
+        CHECK(readCall.operation == Capture::Instruction::Operation::Call);
+        CHECK(readCall.argumentCount == 2 && readCall.arguments[1] == 0x40);
+        CHECK(readCall.selector == "objectForKey:");
+        CHECK(readFunction.instructions[1].operation == Capture::Instruction::Operation::SetRegister);
+        CHECK(readFunction.instructions[1].value == 0x10);
+    }
+
+    CHECK(!reader.next(type, readView, readFunction));
+    std::remove(path.c_str());
+}
+
+TEST(captureRejectsInvalidRecords)
+{
+    const auto path = temporaryPath("invalid.capture");
+
+    Capture::FunctionRecord badFlags;
+    badFlags.flags = 0x80;
+
+    Capture::FunctionRecord badOperation;
+    Capture::Instruction insn;
+    insn.operation = static_cast<Capture::Instruction::Operation>(0x7f);
+    badOperation.instructions.push_back(insn);
+
+    for (const auto& record : { badFlags, badOperation }) {
+        {
+            Capture::Writer writer(path);
+            writer.write(record);
+        }
+
+        Capture::Reader reader(path);
+        Capture::RecordType type;
+        Capture::ViewRecord view;
+        Capture::FunctionRecord function;
+        CHECK(reader.isOpen());
+        CHECK(!reader.next(type, view, function));
+    }
+    std::remove(path.c_str());
+}
@@ -0,0 +1,121 @@
+#include "Test.h"
+
+#include "ClassMethodIndex.h"
+
+#include <vector>
+
+namespace {
+
+constexpr uint64_t Base = 0x1000;
+constexpr uint64_t Derived = 0x2000;
+constexpr uint64_t BaseMeta = 0x9000;
+constexpr uint64_t DerivedMeta = 0x9100;
+
+constexpr uint64_t Init = 0x10;
+constexpr uint64_t Count = 0x20;
+constexpr uint64_t Describe = 0x30;
+constexpr uint64_t Shared = 0x40;
+
+/**
+ * Build an index of a class and its subclass, each with a category, along
+ * with their metaclasses. Classes are added subclass first to check the
+ * hierarchy doesn't depend on the order they are added in.
+ */
+ClassMethodIndex buildIndex()
+{
+    ClassMethodIndex::Builder builder;
+    builder.addClass(Derived, Base, DerivedMeta, { { Init, 0xb10 } });
+    builder.addClass(DerivedMeta, BaseMeta, 0, {});
+    builder.addClass(Base, 0, BaseMeta, { { Init, 0xa10 }, { Count, 0xa20 } });
+    builder.addClass(BaseMeta, 0, 0, { { Shared, 0xe40 } });
+    builder.addCategory(Derived, { { Describe, 0xc30 }, { Init, 0xc10 } });
+    builder.addCategory(Base, { { Count, 0xd20 } });
+    return builder.build();
+}
+
+} // unnamed namespace
+
+TEST(classMethodIndexFlattensHierarchy)
+{
+    const auto index = buildIndex();
+    CHECK(index.size() == 4);
+
+    // Categories take precedence over a class's own methods, and a subclass
+    // over its superclass.
+    CHECK(index.find(Derived, Init) == 0xc10);
+    CHECK(index.find(Derived, Count) == 0xd20);
+    CHECK(index.find(Derived, Describe) == 0xc30);
+    CHECK(index.find(Base, Init) == 0xa10);
+    CHECK(index.find(Base, Count) == 0xd20);
+
+    // Methods of a subclass or its categories aren't inherited upwards.
+    CHECK(!index.find(Base, Describe));
+
+    // Class methods resolve through the metaclass hierarchy.
+    CHECK(index.find(DerivedMeta, Shared) == 0xe40);
+    CHECK(!index.find(Derived, Shared));
+
+    CHECK(!index.find(0x3000, Init));
+}
+
+TEST(classMethodIndexMetaclasses)
+{
+    const auto index = buildIndex();
+    CHECK(index.isClass(Derived));
+    CHECK(index.metaclass(Derived) == DerivedMeta);
+    CHECK(index.metaclass(Base) == BaseMeta);
+    CHECK(!index.isClass(DerivedMeta));
+    CHECK(!index.isClass(0x3000));
+}
+
+TEST(classMethodIndexHandlesOddHierarchies)
+{
+    ClassMethodIndex::Builder builder;
+
+    // A superclass chain with a cycle, and a superclass outside the image.
+    builder.addClass(0x1000, 0x2000, 0x9000, { { Init, 0xa10 } });
+    builder.addClass(0x2000, 0x1000, 0x9100, { { Count, 0xb20 } });
+    builder.addClass(0x3000, 0x7000, 0x9200, { { Init, 0xc10 } });
+
+    // Of two definitions of a class, the first wins.
+    builder.addClass(0x3000, 0, 0x9300, { { Init, 0xd10 } });
+
+    const auto index = builder.build();
+    CHECK(index.size() == 3);
+    CHECK(index.find(0x1000, Count) == 0xb20);
+    CHECK(index.find(0x2000, Init) == 0xa10);
+    CHECK(index.find(0x3000, Init) == 0xc10);
+    CHECK(index.metaclass(0x3000) == 0x9200);
+}
+
+TEST(classMethodIndexRoundTrip)
+{
+    const auto index = buildIndex();
+    std::vector<uint8_t> data;
+    index.serialize(data);
+
+    const uint8_t* cursor = data.data();
+    const auto loaded = ClassMethodIndex::deserialize(cursor, data.data() + data.size());
+    CHECK(loaded.has_value());
+    CHECK(cursor == data.data() + data.size());
+    if (!loaded)
+        return;
+
+    CHECK(loaded->size() == index.size());
+    CHECK(loaded->methodCount() == index.methodCount());
+    CHECK(loaded->find(Derived, Init) == 0xc10);
+    CHECK(loaded->metaclass(Base) == BaseMeta);
+
+    for (size_t size = 0; size < data.size(); ++size) {
+        cursor = data.data();
+        CHECK(!ClassMethodIndex::deserialize(cursor, data.data() + size));
+    }
+
+    // A default-constructed index loads back as an empty one.
+    std::vector<uint8_t> empty;
+    ClassMethodIndex().serialize(empty);
+    cursor = empty.data();
+    const auto loadedEmpty = ClassMethodIndex::deserialize(cursor, empty.data() + empty.size());
+    CHECK(loadedEmpty && loadedEmpty->empty());
+    CHECK(loadedEmpty && !loadedEmpty->find(Base, Init));
+}
@@ -0,0 +1,84 @@
+#include "Test.h"
+
+#include "ContentStore.h"
+
+#include <memory>
+#include <string_view>
+
+namespace {
+
+ContentHash::Digest hashOf(std::string_view text)
+{
+    ContentHash hash;
+    hash.add(text);
+    return hash.digest();
+}
+
+} // unnamed namespace
+
+TEST(contentHashIsStable)
+{
+    // Digests are stored in databases alongside the indexes they key, so
+    // they must not change between builds.
+    ContentHash hash;
+    hash.add(0x100000000);
+    hash.add(std::string_view("objectForKey:"));
+    CHECK((hash.digest() == ContentHash::Digest { 0xc67150eea50fbc63, 0x6198cf92e9f9f8d5 }));
+}
+
+TEST(contentHashDistinguishesInputs)
+{
+    CHECK(hashOf("objectForKey:") == hashOf("objectForKey:"));
+    CHECK(hashOf("objectForKey:") != hashOf("objectForKeyedSubscript:"));
+    CHECK(ContentHash().digest() != hashOf(""));
+
+    // Ranges are prefixed by their size, so trailing zero bytes count.
+    CHECK(hashOf("ab") != hashOf(std::string_view("ab\0", 3)));
+    CHECK(hashOf(std::string_view("\0", 1)) != hashOf(""));
+
+    // The order of values counts, and an odd number of values isn't the
+    // same as padding them with a zero.
+    ContentHash forward, backward, odd, padded;
+    forward.add(1);
+    forward.add(2);
+    backward.add(2);
+    backward.add(1);
+    odd.add(1);
+    padded.add(1);
+    padded.add(0);
+    CHECK(forward.digest() != backward.digest());
+    CHECK(odd.digest() != padded.digest());
+
+    // A single flipped bit changes both halves of the digest.
+    ContentHash low, flipped;
+    low.add(0x1000);
+    flipped.add(0x1001);
+    CHECK(low.digest().first != flipped.digest().first);
+    CHECK(low.digest().second != flipped.digest().second);
+}
+
+TEST(contentStoreSharesLiveObjects)
+{
+    ContentStore<int> store;
+    const auto key = hashOf("tables");
+    CHECK(store.find(key) == nullptr);
+
+    auto first = store.insert(key, std::make_shared<const int>(1));
+    CHECK(first && *first == 1);
+
+    // An object added for a key with a live object gets the live one back.
+    auto second = store.insert(key, std::make_shared<const int>(2));
+    CHECK(second == first);
+    CHECK(store.find(key) == first);
+    CHECK(store.size() == 1);
+
+    // Once every user is gone, the key can be filled again.
+    first.reset();
+    second.reset();
+    CHECK(store.find(key) == nullptr);
+    CHECK(store.size() == 0);
+
+    auto third = store.insert(key, std::make_shared<const int>(3));
+    CHECK(third && *third == 3);
+    CHECK(store.find(hashOf("other")) == nullptr);
+}
@@ -0,0 +1,119 @@
+#include "Corpus.h"
+
+namespace {
+
+constexpr uint64_t ImageBase = 0x100000000;
+constexpr uint64_t TextStart = ImageBase + 0x4000;
+constexpr uint64_t StubsStart = ImageBase + 0x2000000;
+constexpr uint64_t SelectorReferencesStart = ImageBase + 0x3000000;
+
+/**
+ * Small, fast and deterministic generator (SplitMix64).
+ */
+class Random {
+    uint64_t m_state;
+
+public:
+    explicit Random(uint64_t seed)
+        : m_state(seed)
+    {
+    }
+
+    uint64_t next()
+    {
+        uint64_t z = (m_state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    size_t below(size_t bound) { return next() % bound; }
+    bool chance(unsigned percent) { return below(100) < percent; }
+};
+
+const char* const Verbs[] = { "init", "set", "get", "perform", "load", "make", "update", "draw",
+    "insert", "remove", "scroll", "present", "dismiss", "encode", "decode", "observe" };
+const char* const Prefixes[] = { "With", "For", "Using", "And", "To", "From", "At", "In" };
+const char* const Nouns[] = { "Frame", "Title", "Object", "URL", "Path", "Data", "Index", "View",
+    "Animated", "Completion", "Handler", "Options", "Error", "Delegate", "Key", "Value", "Rect",
+    "Color", "Font", "Item", "Section", "Row", "Coder", "Block" };
+
+template <typename T, size_t N>
+const char* pick(Random& random, T (&words)[N])
+{
+    return words[random.below(N)];
+}
+
+std::string makeSelector(Random& random, size_t index)
+{
+    // Keep every selector unique by folding the index into the first noun.
+    std::string selector = pick(random, Verbs);
+    selector += pick(random, Nouns);
+    selector += std::to_string(index);
+
+    const auto argumentCount = random.below(5);
+    if (argumentCount == 0)
+        return selector;
+
+    selector += pick(random, Prefixes);
+    selector += pick(random, Nouns);
+    selector += ':';
+    for (size_t i = 1; i < argumentCount; ++i) {
+        std::string label = random.chance(50) ? pick(random, Prefixes) : "";
+        label += pick(random, Nouns);
+        label[0] = static_cast<char>(tolower(label[0]));
+        selector += label;
+        selector += ':';
+    }
+
+    return selector;
+}
+
+} // unnamed namespace
+
+Corpus Corpus::generate(size_t selectorCount, size_t callSiteCount, uint64_t seed)
+{
+    Random random(seed);
+    Corpus corpus;
+
+    corpus.selectors.reserve(selectorCount);
+    corpus.selectorReferences.reserve(selectorCount);
+    corpus.implementations.reserve(selectorCount);
+    for (size_t i = 0; i < selectorCount; ++i) {
+        corpus.selectors.push_back(makeSelector(random, i));
+        corpus.selectorReferences.push_back(SelectorReferencesStart + i * 8);
+
+        // Most selectors have a single implementation; a few are overridden
+        // by several classes, and some have none in this image.
+        std::vector<uint64_t> implementations;
+        const auto implementationCount = random.chance(10) ? 0 : random.chance(90) ? 1 : 2 + random.below(6);
+        for (size_t j = 0; j < implementationCount; ++j)
+            implementations.push_back(TextStart + (random.below(0x1000000) & ~uint64_t(3)));
+        corpus.implementations.push_back(std::move(implementations));
+    }
+
+    // Message send functions, their variants and a set of selector stubs.
+    const CallTargetKind messageSendKinds[] = { CallTargetKind::MessageSend, CallTargetKind::MessageSend,
+        CallTargetKind::MessageSendSuper, CallTargetKind::MessageSendSuper,
+        CallTargetKind::MessageSendStret, CallTargetKind::MessageSendSuperStret };
+    for (size_t i = 0; i < std::size(messageSendKinds); ++i)
+        corpus.callTargets.emplace_back(StubsStart + i * 12, messageSendKinds[i]);
+    for (size_t i = 0; i < selectorCount / 16; ++i)
+        corpus.callTargets.emplace_back(StubsStart + 0x1000 + i * 32, CallTargetKind::SelectorStub);
+
+    corpus.callSites.reserve(callSiteCount);
+    for (size_t i = 0; i < callSiteCount; ++i) {
+        CallSite site;
+        if (random.chance(35))
+            site.target = corpus.callTargets[random.below(corpus.callTargets.size())].first;
+        else
+            site.target = TextStart + (random.below(0x1000000) & ~uint64_t(3));
+
+        // Selector references past the end of the table model references to
+        // selectors with no implementation in the image.
+        site.selectorReference = SelectorReferencesStart + random.below(selectorCount + selectorCount / 8) * 8;
+        corpus.callSites.push_back(site);
+    }
+
+    return corpus;
+}
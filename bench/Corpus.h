@@ -0,0 +1,43 @@
+#pragma once
+
+#include "CallTargetTable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * A single call site in the synthetic corpus.
+ */
+struct CallSite {
+    /**
+     * Address of the call target; one of the message send functions for
+     * roughly a third of the call sites.
+     */
+    uint64_t target;
+
+    /**
+     * Address of the selector reference passed, which has no known
+     * implementation for a fraction of the call sites.
+     */
+    uint64_t selectorReference;
+};
+
+/**
+ * Synthetic, deterministic stand-in for the Objective-C metadata of a large
+ * binary, shaped after what the plugin sees in real images.
+ */
+struct Corpus {
+    std::vector<std::string> selectors;
+    std::vector<uint64_t> selectorReferences;
+    std::vector<std::vector<uint64_t>> implementations;
+    std::vector<std::pair<uint64_t, CallTargetKind>> callTargets;
+    std::vector<CallSite> callSites;
+
+    /**
+     * Generate a corpus with the given number of selectors and call sites.
+     */
+    static Corpus generate(size_t selectorCount, size_t callSiteCount, uint64_t seed = 1);
+};
@@ -0,0 +1,78 @@
+#include "Harness.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> g_allocationCount = 0;
+
+void* allocate(size_t size)
+{
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (auto ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+} // unnamed namespace
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+uint64_t allocationCount()
+{
+    return g_allocationCount.load(std::memory_order_relaxed);
+}
+
+void Harness::run(const std::string& name, size_t operations, const std::function<void()>& body)
+{
+    if (!m_filter.empty() && name.find(m_filter) == std::string::npos)
+        return;
+
+    auto bestTime = std::numeric_limits<double>::max();
+    uint64_t allocations = 0;
+    for (size_t i = 0; i < std::max<size_t>(m_repeat, 1); ++i) {
+        const auto allocationsBefore = allocationCount();
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        const auto end = std::chrono::steady_clock::now();
+
+        bestTime = std::min(bestTime, std::chrono::duration<double, std::nano>(end - start).count());
+        allocations = allocationCount() - allocationsBefore;
+    }
+
+    BenchmarkResult result;
+    result.name = name;
+    result.operations = operations;
+    result.nanosecondsPerOperation = operations ? bestTime / operations : 0;
+    result.allocationsPerOperation = operations ? static_cast<double>(allocations) / operations : 0;
+    m_results.push_back(result);
+
+    std::fprintf(stderr, "  %s done\n", name.c_str());
+}
+
+void Harness::print(bool csv) const
+{
+    if (csv) {
+        std::printf("benchmark,operations,ns_per_op,allocs_per_op\n");
+        for (const auto& result : m_results)
+            std::printf("%s,%zu,%.3f,%.3f\n", result.name.c_str(), result.operations,
+                result.nanosecondsPerOperation, result.allocationsPerOperation);
+        return;
+    }
+
+    std::printf("%-32s %12s %12s %12s\n", "benchmark", "operations", "ns/op", "allocs/op");
+    for (const auto& result : m_results)
+        std::printf("%-32s %12zu %12.2f %12.3f\n", result.name.c_str(), result.operations,
+            result.nanosecondsPerOperation, result.allocationsPerOperation);
+}
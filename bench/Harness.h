@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Result of running a single benchmark.
+ */
+struct BenchmarkResult {
+    std::string name;
+    size_t operations = 0;
+    double nanosecondsPerOperation = 0;
+    double allocationsPerOperation = 0;
+};
+
+/**
+ * Runs benchmarks and collects their results.
+ *
+ * Each benchmark body performs a fixed number of operations per call; the
+ * body is run `repeat` times and the fastest run is reported. Allocations are
+ * counted through the global allocation functions, which the harness
+ * replaces, so only allocations made by the body itself are attributed to it.
+ */
+class Harness {
+    size_t m_repeat;
+    std::string m_filter;
+    std::vector<BenchmarkResult> m_results;
+
+public:
+    explicit Harness(size_t repeat = 3, std::string filter = {})
+        : m_repeat(repeat)
+        , m_filter(std::move(filter))
+    {
+    }
+
+    /**
+     * Run a benchmark whose body performs `operations` operations, unless it
+     * is excluded by the name filter.
+     */
+    void run(const std::string& name, size_t operations, const std::function<void()>& body);
+
+    /**
+     * Print all results as an aligned table, or as CSV.
+     */
+    void print(bool csv) const;
+
+    const std::vector<BenchmarkResult>& results() const { return m_results; }
+};
+
+/**
+ * Get the number of allocations made by the process so far.
+ */
+uint64_t allocationCount();
+
+/**
+ * Keep the compiler from optimizing away a computed value.
+ */
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
@@ -0,0 +1,39 @@
+#include "Test.h"
+
+#include "LruCache.h"
+
+#include <vector>
+
+TEST(lruEvictsLeastRecentlyUsed)
+{
+    LruCache<int, int> cache(2);
+    cache.insert(1, 10);
+    cache.insert(2, 20);
+
+    // Looking up 1 makes 2 the least recently used entry.
+    CHECK(cache.find(1) && *cache.find(1) == 10);
+    cache.insert(3, 30);
+    CHECK(cache.size() == 2);
+    CHECK(cache.find(2) == nullptr);
+    CHECK(cache.find(1) != nullptr);
+    CHECK(cache.find(3) != nullptr);
+}
+
+TEST(lruReplaceRefreshesEntry)
+{
+    LruCache<int, int> cache(2);
+    cache.insert(1, 10);
+    cache.insert(2, 20);
+    cache.insert(1, 11);
+    cache.insert(3, 30);
+
+    CHECK(cache.find(2) == nullptr);
+    CHECK(cache.find(1) && *cache.find(1) == 11);
+
+    std::vector<int> order;
+    cache.forEach([&](int key, int) { order.push_back(key); });
+    CHECK((order == std::vector<int> { 1, 3 }));
+
+    LruCache<int, int> empty(0);
+    CHECK(empty.capacity() == 1);
+}
@@ -0,0 +1,439 @@
+#include "Corpus.h"
+#include "Harness.h"
+
+#include "CallTargetTable.h"
+#include "ContentStore.h"
+#include "LruCache.h"
+#include "Selector.h"
+#include "SelectorImplementationIndex.h"
+#include "SelectorStrings.h"
+#include "TypeEncoding.h"
+#include "ViewRegistry.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct Options {
+    size_t selectorCount = 500000;
+    size_t callSiteCount = 2000000;
+    size_t repeat = 3;
+    size_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    std::string filter;
+    bool csv = false;
+};
+
+void printUsage(const char* program)
+{
+    std::fprintf(stderr,
+        "Usage: %s [options]\n"
+        "\n"
+        "  --selectors <n>   Number of selectors in the corpus (default: 500000)\n"
+        "  --calls <n>       Number of call sites in the corpus (default: 2000000)\n"
+        "  --repeat <n>      Runs per benchmark; the fastest is reported (default: 3)\n"
+        "  --threads <n>     Extra thread count for the contention sweep of 1, 2, 4 and 8\n"
+        "                    threads (default: all cores)\n"
+        "  --filter <text>   Only run benchmarks whose name contains <text>\n"
+        "  --csv             Print results as CSV\n",
+        program);
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const auto hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--selectors") && hasValue)
+            options.selectorCount = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--calls") && hasValue)
+            options.callSiteCount = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--repeat") && hasValue)
+            options.repeat = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--threads") && hasValue)
+            options.threadCount = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--filter") && hasValue)
+            options.filter = argv[++i];
+        else if (!std::strcmp(argv[i], "--csv"))
+            options.csv = true;
+        else
+            return false;
+    }
+
+    return options.selectorCount > 0 && options.callSiteCount > 0 && options.threadCount > 0;
+}
+
+SelectorImplementationIndex buildIndex(const Corpus& corpus)
+{
+    SelectorImplementationIndex::Builder builder;
+    for (size_t i = 0; i < corpus.selectorReferences.size(); ++i)
+        if (!corpus.implementations[i].empty())
+            builder.add(corpus.selectorReferences[i], corpus.implementations[i]);
+    return builder.build();
+}
+
+void runSelectorBenchmarks(Harness& harness, const Corpus& corpus)
+{
+    constexpr size_t MaxComponents = 16;
+    const auto& selectors = corpus.selectors;
+
+    harness.run("selector.split", selectors.size(), [&] {
+        std::string_view components[MaxComponents];
+        for (const auto& selector : selectors)
+            doNotOptimize(splitSelector(selector, components, MaxComponents));
+    });
+
+    std::vector<std::string_view> components;
+    for (const auto& selector : selectors) {
+        std::string_view buffer[MaxComponents];
+        const auto count = std::min(splitSelector(selector, buffer, MaxComponents), MaxComponents);
+        components.insert(components.end(), buffer, buffer + count);
+    }
+
+    harness.run("selector.argumentName", components.size(), [&] {
+        for (const auto component : components)
+            doNotOptimize(ArgumentNameFromSelectorComponent(component));
+    });
+
+    // Split each selector and derive all of its argument names.
+    harness.run("selector.parse", selectors.size(), [&] {
+        std::string_view buffer[MaxComponents];
+        for (const auto& selector : selectors) {
+            const auto count = std::min(splitSelector(selector, buffer, MaxComponents), MaxComponents);
+            for (size_t i = 0; i < count; ++i)
+                doNotOptimize(ArgumentNameFromSelectorComponent(buffer[i]));
+        }
+    });
+}
+
+/**
+ * Lay the corpus selectors out as a selector name section, with each
+ * selector reference pointing to its name.
+ */
+SelectorStrings buildSelectorStrings(const Corpus& corpus)
+{
+    constexpr uint64_t NamesStart = 0x10000000;
+
+    std::vector<uint8_t> names;
+    SelectorStrings::Builder builder;
+    for (size_t i = 0; i < corpus.selectors.size(); ++i) {
+        builder.addRef(corpus.selectorReferences[i], NamesStart + names.size());
+        names.insert(names.end(), corpus.selectors[i].begin(), corpus.selectors[i].end());
+        names.push_back(0);
+    }
+    builder.addNames(NamesStart, names.data(), names.size());
+    return builder.build();
+}
+
+void runStringBenchmarks(Harness& harness, const Corpus& corpus)
+{
+    const auto& callSites = corpus.callSites;
+
+    harness.run("strings.build", corpus.selectors.size(), [&] {
+        doNotOptimize(buildSelectorStrings(corpus));
+    });
+
+    // Hash a selector name section, as is done for every view's sections to
+    // find tables it can share with other views. One operation is one byte.
+    std::vector<uint8_t> names;
+    for (const auto& selector : corpus.selectors)
+        names.insert(names.end(), selector.c_str(), selector.c_str() + selector.size() + 1);
+    harness.run("strings.hash", names.size(), [&] {
+        ContentHash hash;
+        hash.add(names.data(), names.size());
+        doNotOptimize(hash.digest());
+    });
+
+    // Resolve the selector text passed at every call site, as the selector
+    // table does on a miss.
+    const auto strings = buildSelectorStrings(corpus);
+    harness.run("strings.resolve", callSites.size(), [&] {
+        size_t length = 0;
+        for (const auto& site : callSites) {
+            if (const auto name = strings.nameForRef(site.selectorReference))
+                length += strings.text(*name)->size();
+        }
+        doNotOptimize(length);
+    });
+}
+
+/**
+ * Make a method type encoding for a selector, drawing each argument's type
+ * from a fixed mix of the types seen in real method lists.
+ */
+std::string encodingFor(const std::string& selector, size_t seed)
+{
+    static const char* const argumentTypes[] = { "@", "q", "B", "Q", "d", "^@", "{CGPoint=dd}", "@?", ":", "r*" };
+    constexpr size_t typeCount = sizeof(argumentTypes) / sizeof(argumentTypes[0]);
+
+    std::string encoding = seed % 3 ? "@" : "v";
+    encoding += "16@0:8";
+    size_t offset = 16;
+    for (const auto c : selector) {
+        if (c != ':')
+            continue;
+        encoding += argumentTypes[seed++ % typeCount];
+        encoding += std::to_string(offset);
+        offset += 8;
+    }
+    return encoding;
+}
+
+void runTypeBenchmarks(Harness& harness, const Corpus& corpus)
+{
+    const auto& callSites = corpus.callSites;
+
+    std::vector<std::string> encodings;
+    std::unordered_map<uint64_t, const std::string*> encodingForReference;
+    encodings.reserve(corpus.selectors.size());
+    for (size_t i = 0; i < corpus.selectors.size(); ++i) {
+        encodings.push_back(encodingFor(corpus.selectors[i], i));
+        encodingForReference.emplace(corpus.selectorReferences[i], &encodings.back());
+    }
+
+    std::vector<const std::string*> siteEncodings;
+    siteEncodings.reserve(callSites.size());
+    for (const auto& site : callSites) {
+        if (const auto it = encodingForReference.find(site.selectorReference); it != encodingForReference.end())
+            siteEncodings.push_back(it->second);
+    }
+
+    // Decode the encoding of the selector at every call site, as is done
+    // once per distinct encoding and argument list when building call types.
+    harness.run("types.decode", siteEncodings.size(), [&] {
+        size_t argumentCount = 0;
+        MethodSignature signature;
+        for (const auto* encoding : siteEncodings) {
+            if (decodeMethodSignature(*encoding, signature))
+                argumentCount += signature.argumentCount;
+        }
+        doNotOptimize(argumentCount);
+    });
+}
+
+void runDispatchBenchmarks(Harness& harness, const Corpus& corpus)
+{
+    const auto& callSites = corpus.callSites;
+
+    harness.run("index.build", corpus.selectors.size(), [&] {
+        doNotOptimize(buildIndex(corpus));
+    });
+
+    const auto index = buildIndex(corpus);
+    std::vector<uint8_t> serialized;
+    index.serialize(serialized);
+
+    harness.run("index.load", index.size(), [&] {
+        const auto* data = serialized.data();
+        doNotOptimize(SelectorImplementationIndex::deserialize(data, data + serialized.size()));
+    });
+
+    harness.run("index.find", callSites.size(), [&] {
+        for (const auto& site : callSites)
+            doNotOptimize(index.find(site.selectorReference));
+    });
+
+    harness.run("callTarget.build", corpus.callTargets.size(), [&] {
+        doNotOptimize(CallTargetTable(corpus.callTargets));
+    });
+
+    const CallTargetTable callTargets(corpus.callTargets);
+    harness.run("callTarget.classify", callSites.size(), [&] {
+        for (const auto& site : callSites)
+            doNotOptimize(callTargets.classify(site.target));
+    });
+
+    // Classify every call site, and resolve the implementation of message
+    // sends as the workflow does.
+    harness.run("dispatch.resolve", callSites.size(), [&] {
+        uint64_t resolved = 0;
+        for (const auto& site : callSites) {
+            if (!isMessageSend(callTargets.classify(site.target)))
+                continue;
+
+            if (const auto implementations = index.find(site.selectorReference); !implementations.empty())
+                resolved += implementations[0];
+        }
+        doNotOptimize(resolved);
+    });
+}
+
+/**
+ * Token rendered for a pointer, as by the relative pointer data renderer.
+ */
+struct RenderedToken {
+    int type;
+    std::string text;
+};
+
+void runRenderBenchmarks(Harness& harness, const Corpus& corpus)
+{
+    // A table of relative pointers, one per selector, to the symbols of a
+    // method list, scrolled through a screen at a time: every scroll step
+    // repaints the whole screen, so each row is rendered many times.
+    constexpr size_t ScreenRows = 64;
+    constexpr size_t ScrollStep = 4;
+
+    std::vector<std::pair<uint64_t, std::string>> symbols;
+    symbols.reserve(corpus.selectors.size());
+    for (size_t i = 0; i < corpus.selectors.size(); ++i)
+        symbols.emplace_back(corpus.selectorReferences[i], "-[Class" + std::to_string(i % 997) + " " + corpus.selectors[i] + "]");
+
+    // The table sits just before the symbols it points to, well within the
+    // reach of a 32-bit offset.
+    const uint64_t tableStart = symbols.front().first - 0x1000000;
+    std::vector<int32_t> table(symbols.size());
+    for (size_t i = 0; i < table.size(); ++i)
+        table[i] = static_cast<int32_t>(symbols[(i * 7919) % symbols.size()].first - (tableStart + i * 4));
+
+    // Stand-in for `GetSymbolByAddress` and `GetFullName`: a lookup in an
+    // ordered map under the core's lock, a new reference-counted symbol
+    // object, and the name copied out of the core and again into a string.
+    struct SymbolObject {
+        std::string name;
+    };
+    const std::map<uint64_t, std::string> symbolMap(symbols.begin(), symbols.end());
+    std::mutex symbolLock;
+    auto resolve = [&](uint64_t pointer) {
+        std::shared_ptr<SymbolObject> symbol;
+        {
+            std::lock_guard<std::mutex> lock(symbolLock);
+            if (auto it = symbolMap.find(pointer); it != symbolMap.end())
+                symbol = std::make_shared<SymbolObject>(SymbolObject { it->second });
+        }
+        if (symbol) {
+            char* name = strdup(symbol->name.c_str());
+            auto token = std::make_shared<const RenderedToken>(RenderedToken { 1, name });
+            free(name);
+            return token;
+        }
+
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "0x%llx", static_cast<unsigned long long>(pointer));
+        return std::make_shared<const RenderedToken>(RenderedToken { 2, buffer });
+    };
+
+    const size_t steps = table.size() > ScreenRows ? (table.size() - ScreenRows) / ScrollStep : 0;
+    const size_t renders = steps * ScreenRows;
+    auto scroll = [&](auto&& render) {
+        size_t length = 0;
+        for (size_t step = 0; step < steps; ++step) {
+            for (size_t row = step * ScrollStep; row < step * ScrollStep + ScreenRows; ++row)
+                length += render(tableStart + row * 4 + table[row])->text.size();
+        }
+        doNotOptimize(length);
+    };
+
+    harness.run("render.uncached", renders, [&] { scroll(resolve); });
+
+    harness.run("render.cached", renders, [&] {
+        LruCache<uint64_t, std::shared_ptr<const RenderedToken>> cache(16384);
+        scroll([&](uint64_t pointer) {
+            if (const auto* token = cache.find(pointer))
+                return *token;
+
+            auto token = resolve(pointer);
+            cache.insert(pointer, token);
+            return token;
+        });
+    });
+}
+
+/**
+ * Registry as it was before `ViewRegistry`: a map behind a shared mutex,
+ * locked on every lookup.
+ */
+class LockedRegistry {
+    mutable std::shared_mutex m_lock;
+    std::unordered_map<size_t, std::unique_ptr<uint64_t>> m_entries;
+
+public:
+    void insert(size_t key, uint64_t value)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_lock);
+        m_entries[key] = std::make_unique<uint64_t>(value);
+    }
+
+    uint64_t* find(size_t key) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_lock);
+        auto it = m_entries.find(key);
+        return it != m_entries.end() ? it->second.get() : nullptr;
+    }
+};
+
+void runRegistryBenchmarks(Harness& harness, const Options& options)
+{
+    static constexpr size_t ViewCount = 4;
+    static constexpr size_t LookupsPerThread = 4000000;
+
+    ViewRegistry<uint64_t> registry;
+    LockedRegistry lockedRegistry;
+    for (size_t i = 0; i < ViewCount; ++i) {
+        registry.findOrCreate(i, [i] { return std::make_unique<uint64_t>(i); });
+        lockedRegistry.insert(i, i);
+    }
+
+    // Each thread stays on one view for long stretches, as analysis threads
+    // do, and all threads share the registry. Both registries are run at
+    // increasing thread counts to show how lookups scale under contention.
+    std::vector<size_t> threadCounts = { 1, 2, 4, 8 };
+    if (std::find(threadCounts.begin(), threadCounts.end(), options.threadCount) == threadCounts.end())
+        threadCounts.push_back(options.threadCount);
+
+    auto runThreads = [&](const std::string& name, size_t threadCount, auto&& find) {
+        harness.run(name + "/" + std::to_string(threadCount) + "t", threadCount * LookupsPerThread, [&] {
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < threadCount; ++t) {
+                threads.emplace_back([&find, t] {
+                    uint64_t sum = 0;
+                    for (size_t i = 0; i < LookupsPerThread; ++i)
+                        sum += *find((t + i / 65536) % ViewCount);
+                    doNotOptimize(sum);
+                });
+            }
+            for (auto& thread : threads)
+                thread.join();
+        });
+    };
+
+    for (const auto threadCount : threadCounts) {
+        runThreads("registry.find", threadCount, [&](size_t key) { return registry.find(key); });
+        runThreads("registry.locked", threadCount, [&](size_t key) { return lockedRegistry.find(key); });
+    }
+}
+
+} // unnamed namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::fprintf(stderr, "Generating corpus (%zu selectors, %zu call sites)...\n", options.selectorCount,
+        options.callSiteCount);
+    const auto corpus = Corpus::generate(options.selectorCount, options.callSiteCount);
+
+    Harness harness(options.repeat, options.filter);
+    runSelectorBenchmarks(harness, corpus);
+    runStringBenchmarks(harness, corpus);
+    runTypeBenchmarks(harness, corpus);
+    runDispatchBenchmarks(harness, corpus);
+    runRenderBenchmarks(harness, corpus);
+    runRegistryBenchmarks(harness, options);
+    harness.print(options.csv);
+
+    return 0;
+}
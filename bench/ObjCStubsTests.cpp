@@ -0,0 +1,137 @@
+#include "Test.h"
+
+#include "ObjCStubs.h"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/**
+ * Assembles ARM64 instructions into a code buffer at a given address.
+ */
+class Assembler {
+    uint64_t m_address;
+    std::vector<uint8_t> m_code;
+
+public:
+    explicit Assembler(uint64_t address)
+        : m_address(address)
+    {
+    }
+
+    uint64_t here() const { return m_address + m_code.size(); }
+    const std::vector<uint8_t>& code() const { return m_code; }
+
+    void emit(uint32_t instruction)
+    {
+        const auto size = m_code.size();
+        m_code.resize(size + sizeof(instruction));
+        std::memcpy(m_code.data() + size, &instruction, sizeof(instruction));
+    }
+
+    void adrp(uint32_t reg, uint64_t target)
+    {
+        const auto pages = static_cast<int64_t>(target >> 12) - static_cast<int64_t>(here() >> 12);
+        const auto immlo = static_cast<uint32_t>(pages & 0x3);
+        const auto immhi = static_cast<uint32_t>((pages >> 2) & 0x7ffff);
+        emit(0x90000000 | (immlo << 29) | (immhi << 5) | reg);
+    }
+
+    void ldr(uint32_t dest, uint32_t base, uint64_t offset)
+    {
+        emit(0xf9400000 | (static_cast<uint32_t>(offset / 8) << 10) | (base << 5) | dest);
+    }
+
+    void br(uint32_t reg) { emit(0xd61f0000 | (reg << 5)); }
+    void b() { emit(0x14000000); }
+    void brk() { emit(0xd4200020); }
+};
+
+std::vector<std::pair<uint64_t, uint64_t>> decode(const Assembler& code, uint64_t address)
+{
+    return decodeArm64SelectorStubs(address, code.code().data(), code.code().size());
+}
+
+} // unnamed namespace
+
+TEST(decodeFastStubs)
+{
+    // Stubs as linked with `-objc_stubs_fast`: 32 bytes each, loading
+    // `objc_msgSend` from the GOT into x16.
+    const uint64_t address = 0x100008000;
+    Assembler code(address);
+    const std::vector<uint64_t> selRefs = { 0x10000c010, 0x10000c018, 0x100020ff8 };
+    for (const auto selRef : selRefs) {
+        code.adrp(1, selRef);
+        code.ldr(1, 1, selRef & 0xfff);
+        code.adrp(16, 0x100004000);
+        code.ldr(16, 16, 0x10);
+        code.br(16);
+        code.brk();
+        code.brk();
+        code.brk();
+    }
+
+    const auto stubs = decode(code, address);
+    CHECK(stubs.size() == selRefs.size());
+    for (size_t i = 0; i < stubs.size() && i < selRefs.size(); ++i) {
+        CHECK(stubs[i].first == address + i * 32);
+        CHECK(stubs[i].second == selRefs[i]);
+    }
+}
+
+TEST(decodeSmallStubs)
+{
+    // Stubs as linked with `-objc_stubs_small`: 12 bytes each, branching to
+    // `objc_msgSend` directly, with selector references on lower pages than
+    // the code.
+    const uint64_t address = 0x100108ffc;
+    Assembler code(address);
+    const std::vector<uint64_t> selRefs = { 0x100004008, 0x100004ff8 };
+    for (const auto selRef : selRefs) {
+        code.adrp(1, selRef);
+        code.ldr(1, 1, selRef & 0xfff);
+        code.b();
+    }
+
+    const auto stubs = decode(code, address);
+    CHECK(stubs.size() == selRefs.size());
+    for (size_t i = 0; i < stubs.size() && i < selRefs.size(); ++i) {
+        CHECK(stubs[i].first == address + i * 12);
+        CHECK(stubs[i].second == selRefs[i]);
+    }
+}
+
+TEST(decodeIgnoresOtherLoads)
+{
+    const uint64_t address = 0x100008000;
+    Assembler code(address);
+
+    // A page loaded into another register, a load into another register, and
+    // a load from another base register are not selector loads.
+    code.adrp(16, 0x10000c000);
+    code.ldr(1, 16, 0x10);
+    code.adrp(1, 0x10000c000);
+    code.ldr(2, 1, 0x10);
+    code.adrp(1, 0x10000c000);
+    code.ldr(1, 2, 0x10);
+
+    // An ADRP as the last instruction has no load to pair with.
+    code.adrp(1, 0x10000c000);
+
+    CHECK(decode(code, address).empty());
+    CHECK(decodeArm64SelectorStubs(address, code.code().data(), 4).empty());
+}
+
+TEST(selectorStubIndexKeepsFirstSelector)
+{
+    const SelectorStubIndex index({ { 0x2000, 0x20 }, { 0x1000, 0x10 }, { 0x2000, 0x30 } });
+    CHECK(index.size() == 2);
+    CHECK(index.find(0x1000) == 0x10);
+    CHECK(index.find(0x2000) == 0x20);
+    CHECK(!index.find(0x1800));
+    CHECK(!index.find(0x3000));
+    CHECK(!SelectorStubIndex().find(0x1000));
+}
@@ -0,0 +1,312 @@
+#include "Harness.h"
+
+#include "AnalysisInfo.h"
+#include "CallSite.h"
+#include "CallTargetTable.h"
+#include "Capture.h"
+#include "Selector.h"
+#include "TypeEncoding.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Replays the rewrite decisions recorded in a capture file written by the
+ * plugin (see `Capture.h`), without Binary Ninja.
+ *
+ * Each view's tables are rebuilt from its view record, then every captured
+ * instruction is run back through the same classification and lookups the
+ * workflow uses, which is timed and summarized. Selectors are read from the
+ * captured selector strings, and method type encodings are decoded as for
+ * call types. Receivers are only resolved when they are a constant class;
+ * tracking them through registers, and building the call types themselves,
+ * depend on the core and are not replayed.
+ *
+ * Functions served from the memo are recorded with the instructions captured
+ * when their memo entry was made, and are replayed like any other.
+ */
+
+namespace {
+
+struct Options {
+    std::string path;
+    size_t repeat = 3;
+    bool resolveDynamicDispatch = true;
+    bool resolveKnownReceivers = false;
+    bool csv = false;
+};
+
+void printUsage(const char* program)
+{
+    std::fprintf(stderr,
+        "Usage: %s [options] <capture>\n"
+        "\n"
+        "  --repeat <n>             Runs of the replay; the fastest is reported (default: 3)\n"
+        "  --no-dynamic-dispatch    Replay as if dynamic dispatch resolution is disabled\n"
+        "  --known-receivers        Replay as if receiver resolution is enabled\n"
+        "  --csv                    Print timings as CSV\n",
+        program);
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const auto hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--repeat") && hasValue)
+            options.repeat = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--no-dynamic-dispatch"))
+            options.resolveDynamicDispatch = false;
+        else if (!std::strcmp(argv[i], "--known-receivers"))
+            options.resolveKnownReceivers = true;
+        else if (!std::strcmp(argv[i], "--csv"))
+            options.csv = true;
+        else if (argv[i][0] != '-' && options.path.empty())
+            options.path = argv[i];
+        else
+            return false;
+    }
+
+    return !options.path.empty() && options.repeat > 0;
+}
+
+/**
+ * A view rebuilt from its view record.
+ */
+struct View {
+    CallTargetTable callTargets;
+    AnalysisInfo info;
+
+    /**
+     * Parsed selectors by selector address, standing in for the view's
+     * selector table.
+     */
+    std::unordered_map<uint64_t, SharedSelectorInfo> selectors;
+};
+
+struct Function {
+    View* view = nullptr;
+    Capture::FunctionRecord record;
+};
+
+/**
+ * Number of times each decision was reached, mirroring the plugin's
+ * performance counters.
+ */
+struct Decisions {
+    size_t calls = 0;
+    size_t messageSendCandidates = 0;
+    size_t unknownSelectors = 0;
+    size_t invalidSelectors = 0;
+    size_t callTypesApplied = 0;
+    size_t encodedCallTypes = 0;
+    size_t receiverResolvedCalls = 0;
+    size_t methodCallRewrites = 0;
+    size_t registerAssignments = 0;
+    size_t cfStringRewrites = 0;
+};
+
+std::unique_ptr<View> buildView(const Capture::ViewRecord& record)
+{
+    auto view = std::make_unique<View>();
+    view->callTargets = CallTargetTable(record.callTargets);
+
+    auto tables = std::make_shared<AnalysisTables>();
+    tables->cfStrings = CFStringIndex(record.cfStrings);
+    tables->selectorStubs = SelectorStubIndex(record.selectorStubs);
+
+    const auto* data = record.selectorIndexes.data();
+    const auto* end = data + record.selectorIndexes.size();
+    if (!record.selectorIndexes.empty()) {
+        auto selRefToImp = SelectorImplementationIndex::deserialize(data, end);
+        auto selToImp = selRefToImp ? SelectorImplementationIndex::deserialize(data, end) : std::nullopt;
+        if (!selRefToImp || !selToImp)
+            return nullptr;
+
+        tables->selRefToImp = std::move(*selRefToImp);
+        tables->selToImp = std::move(*selToImp);
+    }
+
+    // Each of the other tables is its own blob, empty if the view had none.
+    const auto load = [](const std::vector<uint8_t>& blob, auto& table) {
+        if (blob.empty())
+            return true;
+
+        const auto* data = blob.data();
+        auto loaded = std::decay_t<decltype(table)>::deserialize(data, data + blob.size());
+        if (!loaded || data != blob.data() + blob.size())
+            return false;
+
+        table = std::move(*loaded);
+        return true;
+    };
+    if (!load(record.selectorStrings, tables->selectorStrings) || !load(record.classes, tables->classes)
+        || !load(record.methodTypes, tables->methodTypes))
+        return nullptr;
+
+    view->info.imageBase = record.imageBase;
+    view->info.tables = std::move(tables);
+    return view;
+}
+
+/**
+ * Run one function's instructions through the workflow's decisions.
+ */
+void replay(View& view, const Capture::FunctionRecord& function, const Options& options, Decisions& decisions)
+{
+    const auto& info = view.info;
+
+    for (const auto& insn : function.instructions) {
+        if (insn.operation == Capture::Instruction::Operation::SetRegister) {
+            ++decisions.registerAssignments;
+            if (info.cfString(insn.value))
+                ++decisions.cfStringRewrites;
+            continue;
+        }
+
+        ++decisions.calls;
+        const auto site = classifyCallSite(view.callTargets, &info, insn.value, insn.argumentCount,
+            [&](size_t index) { return insn.arguments[index]; });
+        if (site.kind == CallTargetKind::None || site.kind == CallTargetKind::Allocate
+            || site.kind == CallTargetKind::ClassOf) {
+            continue;
+        }
+
+        ++decisions.messageSendCandidates;
+        if (site.kind == CallTargetKind::SelectorStub || site.selector == 0) {
+            ++decisions.unknownSelectors;
+            continue;
+        }
+
+        // Selectors outside the captured sections fall back to the text read
+        // by the plugin.
+        auto& selector = view.selectors[site.selector];
+        if (!selector) {
+            const auto text = info.selectorText(site.selector);
+            selector = ParseSelector(text ? std::string(*text) : insn.selector);
+        }
+
+        // Unreadable selectors still get the generic call type.
+        if (!selector->valid) {
+            ++decisions.invalidSelectors;
+        } else if (const auto encoding = info.methodEncoding(site.selector)) {
+            MethodSignature signature;
+            if (decodeMethodSignature(*encoding, signature))
+                ++decisions.encodedCallTypes;
+        }
+        ++decisions.callTypesApplied;
+
+        if (site.kind == CallTargetKind::MessageSendSuper || site.kind == CallTargetKind::MessageSendSuperStret)
+            continue;
+
+        // Only constant class receivers can be told from the capture.
+        const auto receiver = site.receiverArgument < insn.argumentCount ? insn.arguments[site.receiverArgument] : 0;
+        if (options.resolveKnownReceivers
+            && (site.kind == CallTargetKind::MessageSend || site.kind == CallTargetKind::MessageSendStret)
+            && receiver && info.isClass(receiver)) {
+            if (info.methodImplementation(receiver, true, site.selector)) {
+                ++decisions.receiverResolvedCalls;
+                ++decisions.methodCallRewrites;
+            }
+            continue;
+        }
+
+        if (options.resolveDynamicDispatch && !info.implementations(site.selector).empty())
+            ++decisions.methodCallRewrites;
+    }
+}
+
+} // unnamed namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    Capture::Reader reader(options.path);
+    if (!reader.isOpen()) {
+        std::fprintf(stderr, "Failed to open capture '%s'\n", options.path.c_str());
+        return 1;
+    }
+
+    std::map<uint64_t, std::unique_ptr<View>> views;
+    std::vector<Function> functions;
+    size_t instructionCount = 0;
+    size_t skippedCount = 0;
+    size_t memoizedCount = 0;
+
+    Capture::RecordType type;
+    Capture::ViewRecord viewRecord;
+    Capture::FunctionRecord functionRecord;
+    while (reader.next(type, viewRecord, functionRecord)) {
+        if (type == Capture::RecordType::View) {
+            auto view = buildView(viewRecord);
+            if (!view) {
+                std::fprintf(stderr, "Malformed tables for session %llu\n",
+                    static_cast<unsigned long long>(viewRecord.session));
+                return 1;
+            }
+            views[viewRecord.session] = std::move(view);
+        } else if (type == Capture::RecordType::Function) {
+            const auto view = views.find(functionRecord.session);
+            if (view == views.end())
+                continue;
+
+            if (functionRecord.flags & Capture::FunctionRecord::Skipped) {
+                ++skippedCount;
+                continue;
+            }
+            if (functionRecord.flags & Capture::FunctionRecord::Memoized)
+                ++memoizedCount;
+
+            instructionCount += functionRecord.instructions.size();
+            functions.push_back({ view->second.get(), std::move(functionRecord) });
+            functionRecord = {};
+        }
+    }
+
+    std::fprintf(stderr, "Loaded %zu views, %zu functions (%zu memoized, %zu skipped), %zu instructions\n",
+        views.size(), functions.size(), memoizedCount, skippedCount, instructionCount);
+    if (functions.empty())
+        return 0;
+
+    Decisions decisions;
+    Harness harness(options.repeat);
+    harness.run("replay.decide", instructionCount, [&]() {
+        for (auto& [session, view] : views)
+            view->selectors.clear();
+
+        decisions = {};
+        for (const auto& function : functions)
+            replay(*function.view, function.record, options, decisions);
+        doNotOptimize(decisions.methodCallRewrites);
+    });
+    harness.print(options.csv);
+
+    std::printf("\n"
+                "calls                    %zu\n"
+                "messageSendCandidates    %zu\n"
+                "unknownSelectors         %zu\n"
+                "invalidSelectors         %zu\n"
+                "callTypesApplied         %zu\n"
+                "encodedCallTypes         %zu\n"
+                "receiverResolvedCalls    %zu\n"
+                "methodCallRewrites       %zu\n"
+                "registerAssignments      %zu\n"
+                "cfStringRewrites         %zu\n",
+        decisions.calls, decisions.messageSendCandidates, decisions.unknownSelectors, decisions.invalidSelectors,
+        decisions.callTypesApplied, decisions.encodedCallTypes, decisions.receiverResolvedCalls,
+        decisions.methodCallRewrites, decisions.registerAssignments,
+        decisions.cfStringRewrites);
+
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "Test.h"
+
+#include "SelectorImplementationIndex.h"
+
+#include <vector>
+
+static SelectorImplementationIndex buildIndex()
+{
+    SelectorImplementationIndex::Builder builder;
+    builder.add(0x3000, { 0x100, 0x200 });
+    builder.add(0x1000, { 0x300 });
+    builder.add(0x2000, { 0x400, 0x500, 0x600 });
+    return builder.build();
+}
+
+TEST(indexRoundTrip)
+{
+    const auto index = buildIndex();
+    std::vector<uint8_t> data;
+    index.serialize(data);
+
+    const uint8_t* cursor = data.data();
+    const auto loaded = SelectorImplementationIndex::deserialize(cursor, data.data() + data.size());
+    CHECK(loaded.has_value());
+    CHECK(cursor == data.data() + data.size());
+    if (!loaded)
+        return;
+
+    CHECK(loaded->size() == 3);
+    const auto implementations = loaded->find(0x2000);
+    CHECK(implementations.size() == 3);
+    CHECK(implementations[0] == 0x400 && implementations[2] == 0x600);
+    CHECK(loaded->find(0x3000).size() == 2);
+    CHECK(loaded->find(0x4000).empty());
+}
+
+TEST(indexRejectsTruncatedData)
+{
+    const auto index = buildIndex();
+    std::vector<uint8_t> data;
+    index.serialize(data);
+
+    // Every strict prefix of the encoding is missing part of some array.
+    for (size_t size = 0; size < data.size(); ++size) {
+        const uint8_t* cursor = data.data();
+        CHECK(!SelectorImplementationIndex::deserialize(cursor, data.data() + size));
+    }
+}
+
+TEST(indexRejectsCorruptData)
+{
+    const auto index = buildIndex();
+    std::vector<uint8_t> data;
+    index.serialize(data);
+
+    // An element count far past the end of the data must fail the bounds
+    // check rather than be read or allocated.
+    for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+        auto corrupt = data;
+        corrupt[i] = 0xff;
+        const uint8_t* cursor = corrupt.data();
+        CHECK(!SelectorImplementationIndex::deserialize(cursor, corrupt.data() + corrupt.size()));
+    }
+}
@@ -0,0 +1,122 @@
+#include "Test.h"
+
+#include "SelectorStrings.h"
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+/**
+ * Build a snapshot of two name sections, added out of order. The last name
+ * in the second section isn't NUL-terminated in the section itself.
+ */
+SelectorStrings buildStrings()
+{
+    const std::string high("count\0objectForKey:\0", 20);
+    const std::string low("init\0dealloc", 12);
+
+    SelectorStrings::Builder builder;
+    builder.addNames(0x2000, reinterpret_cast<const uint8_t*>(high.data()), high.size());
+    builder.addNames(0x1000, reinterpret_cast<const uint8_t*>(low.data()), low.size());
+    builder.addRef(0x5010, 0x2006);
+    builder.addRef(0x5000, 0x1000);
+    builder.addRef(0x5008, 0x2006);
+    builder.addRef(0x5000, 0x2000);
+    return builder.build();
+}
+
+bool hasText(const SelectorStrings& strings, uint64_t address, std::string_view expected)
+{
+    const auto text = strings.text(address);
+    return text && *text == expected;
+}
+
+} // unnamed namespace
+
+TEST(selectorStringsText)
+{
+    const auto strings = buildStrings();
+    CHECK(hasText(strings, 0x1000, "init"));
+    CHECK(hasText(strings, 0x1005, "dealloc"));
+    CHECK(hasText(strings, 0x2000, "count"));
+    CHECK(hasText(strings, 0x2006, "objectForKey:"));
+
+    // An address inside a name gives the rest of it.
+    CHECK(hasText(strings, 0x2009, "ectForKey:"));
+
+    // Before, between and after the sections.
+    CHECK(!strings.text(0xfff));
+    CHECK(!strings.text(0x100c));
+    CHECK(!strings.text(0x2014));
+    CHECK(!SelectorStrings().text(0x1000));
+}
+
+TEST(selectorStringsRefs)
+{
+    const auto strings = buildStrings();
+    CHECK(strings.refCount() == 3);
+
+    // The first name added for a reference wins.
+    CHECK(strings.nameForRef(0x5000) == 0x1000);
+    CHECK(strings.nameForRef(0x5008) == 0x2006);
+    CHECK(strings.nameForRef(0x5010) == 0x2006);
+    CHECK(!strings.nameForRef(0x5004));
+    CHECK(!strings.nameForRef(0x5018));
+
+    CHECK((strings.references() == std::vector<uint64_t> { 0x5000, 0x5008, 0x5010 }));
+    CHECK((strings.referencedNames() == std::vector<uint64_t> { 0x1000, 0x2006 }));
+}
+
+TEST(selectorStringsRoundTrip)
+{
+    const auto strings = buildStrings();
+    std::vector<uint8_t> data;
+    strings.serialize(data);
+
+    const uint8_t* cursor = data.data();
+    const auto loaded = SelectorStrings::deserialize(cursor, data.data() + data.size());
+    CHECK(loaded.has_value());
+    CHECK(cursor == data.data() + data.size());
+    if (!loaded)
+        return;
+
+    CHECK(loaded->textSize() == strings.textSize());
+    CHECK(hasText(*loaded, 0x1005, "dealloc"));
+    CHECK(hasText(*loaded, 0x2006, "objectForKey:"));
+    CHECK(loaded->nameForRef(0x5008) == 0x2006);
+    CHECK(loaded->references() == strings.references());
+}
+
+TEST(selectorStringsRejectInvalidData)
+{
+    const auto strings = buildStrings();
+    std::vector<uint8_t> data;
+    strings.serialize(data);
+
+    for (size_t size = 0; size < data.size(); ++size) {
+        const uint8_t* cursor = data.data();
+        CHECK(!SelectorStrings::deserialize(cursor, data.data() + size));
+    }
+
+    // The header is three counts, followed by the text, the sections and
+    // the references.
+    const size_t textOffset = 3 * sizeof(uint64_t);
+    const size_t refsOffset = textOffset + strings.textSize() + 2 * 3 * sizeof(uint64_t);
+
+    // A section whose text isn't followed by a NUL. The first section in the
+    // text is the first one added, which is 20 bytes.
+    auto unterminated = data;
+    unterminated[textOffset + 20] = 'x';
+    const uint8_t* cursor = unterminated.data();
+    CHECK(!SelectorStrings::deserialize(cursor, unterminated.data() + unterminated.size()));
+
+    // References out of order.
+    auto unsorted = data;
+    std::memcpy(unsorted.data() + refsOffset, data.data() + refsOffset + sizeof(uint64_t), sizeof(uint64_t));
+    std::memcpy(unsorted.data() + refsOffset + sizeof(uint64_t), data.data() + refsOffset, sizeof(uint64_t));
+    cursor = unsorted.data();
+    CHECK(!SelectorStrings::deserialize(cursor, unsorted.data() + unsorted.size()));
+}
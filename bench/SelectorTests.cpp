@@ -0,0 +1,49 @@
+#include "Test.h"
+
+#include "Selector.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+TEST(parseSelectorArgumentNames)
+{
+    const auto selector = ParseSelector("initWithTitle:forURL:usingBlock:");
+    CHECK(selector->valid);
+    CHECK(selector->argumentCount == 3);
+    CHECK(selector->components.size() == 3);
+    CHECK((selector->argumentNames == std::vector<std::string> { "title", "URL", "block" }));
+
+    CHECK(ParseSelector("setTitle:")->argumentNames[0] == "title");
+    CHECK(ParseSelector("objectForKey:")->argumentNames[0] == "key");
+    CHECK(ParseSelector("dataUsingEncoding:")->argumentNames[0] == "encoding");
+    CHECK(ParseSelector("count")->argumentCount == 0);
+
+    // Components with no recognized leading or middle word are used as is.
+    CHECK(ParseSelector("insertObject:atIndex:")->argumentNames[1] == "atIndex");
+}
+
+TEST(parseSelectorRejectsInvalidText)
+{
+    CHECK(!ParseSelector("")->valid);
+    CHECK(!ParseSelector(std::string("set\x01Value:"))->valid);
+    CHECK(ParseSelector("")->argumentNames.empty());
+}
+
+TEST(splitSelectorReportsTotalComponents)
+{
+    std::string_view components[2];
+    CHECK(splitSelector("a:b::c:", components, 2) == 3);
+    CHECK(components[0] == "a" && components[1] == "b");
+
+    CHECK(splitSelector("count", components, 2) == 1);
+    CHECK(components[0] == "count");
+    CHECK(splitSelector("", components, 2) == 0);
+}
+
+TEST(argumentNameFromPrefix)
+{
+    CHECK(SelectorComponentWithoutPrefix("initWith", "initWithPath") == "path");
+    CHECK(SelectorComponentWithoutPrefix("initWith", "initWithpath") == "");
+    CHECK(SelectorComponentWithoutPrefix("initWith", "init") == "");
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+ * Focused tests for the parts of the core that don't depend on Binary Ninja.
+ *
+ * Each test file defines its tests with `TEST`, which registers them with the
+ * test runner, and reports failed checks through `CHECK`; the runner exits
+ * with a non-zero status if any check failed.
+ */
+
+namespace Test {
+
+/**
+ * Register a test with the runner; used through `TEST`.
+ */
+struct Registration {
+    Registration(const char* name, void (*run)());
+};
+
+/**
+ * Report a failed check; used through `CHECK`.
+ */
+void fail(const char* file, int line, const char* condition);
+
+} // namespace Test
+
+#define TEST(name)                                                           \
+    static void test_##name();                                               \
+    static const Test::Registration registration_##name(#name, test_##name); \
+    static void test_##name()
+
+#define CHECK(condition)                                \
+    do {                                                \
+        if (!(condition))                               \
+            Test::fail(__FILE__, __LINE__, #condition); \
+    } while (false)
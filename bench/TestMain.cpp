@@ -0,0 +1,58 @@
+#include "Test.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+/**
+ * Get the registered tests. A function-local list, since tests register from
+ * static initializers in other translation units.
+ */
+std::vector<TestCase>& registeredTests()
+{
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+size_t g_failureCount = 0;
+
+} // unnamed namespace
+
+Test::Registration::Registration(const char* name, void (*run)())
+{
+    registeredTests().push_back({ name, run });
+}
+
+void Test::fail(const char* file, int line, const char* condition)
+{
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+    ++g_failureCount;
+}
+
+/**
+ * Run every registered test, or only those whose name contains the first
+ * argument.
+ */
+int main(int argc, char* argv[])
+{
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+
+    for (const auto& test : registeredTests()) {
+        if (filter && !std::strstr(test.name, filter))
+            continue;
+
+        const auto failuresBefore = g_failureCount;
+        test.run();
+        std::printf("%s %s\n", g_failureCount == failuresBefore ? "PASS" : "FAIL", test.name);
+    }
+
+    return g_failureCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
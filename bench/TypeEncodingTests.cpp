@@ -0,0 +1,53 @@
+#include "Test.h"
+
+#include "TypeEncoding.h"
+
+#include <string>
+
+TEST(decodeSimpleSignature)
+{
+    MethodSignature signature;
+    CHECK(decodeMethodSignature("v24@0:8@16", signature));
+    CHECK(signature.returnType.kind == EncodedTypeKind::Void);
+    CHECK(signature.argumentCount == 3);
+    CHECK(signature.arguments[0].kind == EncodedTypeKind::Object);
+    CHECK(signature.arguments[1].kind == EncodedTypeKind::Selector);
+    CHECK(signature.arguments[2].kind == EncodedTypeKind::Object);
+}
+
+TEST(decodeQualifiedAndNamedTypes)
+{
+    MethodSignature signature;
+    CHECK(decodeMethodSignature("r*32@0:8@\"NSString\"16^{CGRect=dd}24", signature));
+    CHECK(signature.returnType.kind == EncodedTypeKind::CString);
+    CHECK(signature.argumentCount == 4);
+    CHECK(signature.arguments[2].kind == EncodedTypeKind::Object);
+    CHECK(signature.arguments[2].name == "NSString");
+    CHECK(signature.arguments[3].kind == EncodedTypeKind::Pointer);
+    CHECK(signature.arguments[3].pointee == EncodedTypeKind::Struct);
+    CHECK(signature.arguments[3].name == "CGRect");
+}
+
+TEST(decodeArraysAndBitfields)
+{
+    MethodSignature signature;
+    CHECK(decodeMethodSignature("Q@:[4i]b3", signature));
+    CHECK(signature.returnType.kind == EncodedTypeKind::UnsignedLongLong);
+    CHECK(signature.argumentCount == 4);
+    CHECK(signature.arguments[2].kind == EncodedTypeKind::Array);
+    CHECK(signature.arguments[2].count == 4);
+    CHECK(signature.arguments[3].kind == EncodedTypeKind::Bitfield);
+    CHECK(signature.arguments[3].count == 3);
+}
+
+TEST(rejectMalformedSignatures)
+{
+    MethodSignature signature;
+    CHECK(!decodeMethodSignature("", signature));
+    CHECK(!decodeMethodSignature("v@:{CGRect=dd", signature));
+    CHECK(!decodeMethodSignature("v@:[4i", signature));
+
+    std::string tooMany = "v@:";
+    tooMany.append(MethodSignature::MaxArguments, 'i');
+    CHECK(!decodeMethodSignature(tooMany, signature));
+}
@@ -0,0 +1,82 @@
+#include "Test.h"
+
+#include "ViewRegistry.h"
+
+#include <memory>
+#include <new>
+#include <thread>
+
+TEST(registryCreatesOnce)
+{
+    ViewRegistry<int> registry;
+    int created = 0;
+    const auto factory = [&] {
+        ++created;
+        return std::make_unique<int>(created);
+    };
+
+    auto* first = registry.findOrCreate(1, factory);
+    auto* second = registry.findOrCreate(1, factory);
+    CHECK(first == second);
+    CHECK(created == 1);
+    CHECK(registry.find(2) == nullptr);
+    CHECK(registry.size() == 1);
+}
+
+TEST(registryEraseInvalidatesCachedLookup)
+{
+    ViewRegistry<int> registry;
+    registry.findOrCreate(1, [] { return std::make_unique<int>(10); });
+
+    // The lookup is now cached for this thread; erasing the entry must bump
+    // the generation so the stale pointer isn't returned.
+    CHECK(registry.find(1) && *registry.find(1) == 10);
+    registry.erase(1);
+    CHECK(registry.find(1) == nullptr);
+
+    registry.findOrCreate(1, [] { return std::make_unique<int>(20); });
+    CHECK(registry.find(1) && *registry.find(1) == 20);
+}
+
+TEST(registryChangeOnOtherThreadInvalidatesCachedLookup)
+{
+    ViewRegistry<int> registry;
+    registry.findOrCreate(1, [] { return std::make_unique<int>(10); });
+    CHECK(registry.find(1) != nullptr);
+
+    std::thread([&] {
+        registry.erase(1);
+        registry.findOrCreate(1, [] { return std::make_unique<int>(30); });
+    }).join();
+
+    CHECK(registry.find(1) && *registry.find(1) == 30);
+}
+
+TEST(registryLookupCacheIsPerRegistry)
+{
+    ViewRegistry<int> first;
+    ViewRegistry<int> second;
+    first.findOrCreate(1, [] { return std::make_unique<int>(1); });
+    second.findOrCreate(1, [] { return std::make_unique<int>(2); });
+
+    CHECK(first.find(1) && *first.find(1) == 1);
+    CHECK(second.find(1) && *second.find(1) == 2);
+    CHECK(first.find(1) && *first.find(1) == 1);
+}
+
+TEST(registryLookupCacheIgnoresReusedAddress)
+{
+    // A registry made where an earlier one was destroyed must not be answered
+    // from the earlier registry's cached lookup, even at the same generation.
+    alignas(ViewRegistry<int>) unsigned char storage[sizeof(ViewRegistry<int>)];
+
+    auto* first = new (storage) ViewRegistry<int>;
+    first->findOrCreate(1, [] { return std::make_unique<int>(1); });
+    CHECK(first->find(1) != nullptr);
+    first->~ViewRegistry();
+
+    auto* second = new (storage) ViewRegistry<int>;
+    second->findOrCreate(2, [] { return std::make_unique<int>(2); });
+    CHECK(second->find(1) == nullptr);
+    second->~ViewRegistry();
+}